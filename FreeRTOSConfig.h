@@ -77,15 +77,103 @@
 #define configUSE_TICK_HOOK			1
 #define configCPU_CLOCK_HZ			( ( unsigned long ) 72000000 )	
 #define configTICK_RATE_HZ			( ( portTickType ) 100 )
-#define configMAX_PRIORITIES		( ( unsigned portBASE_TYPE ) 5 )
+#define configMAX_PRIORITIES		( 5 )
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 128 )
-#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 17 * 1024 ) )
+#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 17 * 1024 - 1280 - 512 - 2048 ) )
 #define configMAX_TASK_NAME_LEN		( 16 )
 #define configUSE_TRACE_FACILITY	1
 #define configUSE_16_BIT_TICKS		0
 #define configIDLE_SHOULD_YIELD		1
 #define configUSE_MUTEXES			1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#define configUSE_TICKLESS_IDLE		1
+
+/* The shell keeps the standard streams of the commands it runs in their
+task tags, see fio-stream.h. */
+#define configUSE_APPLICATION_TASK_TAG	1
+
+/* Run time statistics, counted by a free running 100kHz timer (TIM2 on the
+board, the host clock in the simulator). */
+#define configGENERATE_RUN_TIME_STATS	1
+#define configRUN_TIME_COUNTER_HZ		100000UL
+void init_run_time_timer(void);
+unsigned long get_run_time_timer(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	init_run_time_timer()
+#define portGET_RUN_TIME_COUNTER_VALUE()			get_run_time_timer()
+
+/* Binary trace recorder, see trace/trace.h.  The ring costs 8 bytes of RAM
+per event. */
+#define configUSE_TRACE_RECORDER		1
+#define configTRACE_RECORDER_EVENTS		128
+
+#if configUSE_TRACE_RECORDER == 1
+	#include "trace/trace.h"
+
+	#define traceTASK_SWITCHED_IN()						trace_task_switch( pxCurrentTCB->uxTCBNumber, pxCurrentTCB->uxPriority )
+	#define traceTASK_CREATE( pxNewTCB )				trace_record( TRACE_TASK_CREATE, ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->uxPriority )
+	#define traceTASK_DELETE( pxTCB )					trace_record( TRACE_TASK_DELETE, ( pxTCB )->uxTCBNumber, 0 )
+	#define traceQUEUE_CREATE( pxNewQueue )				( pxNewQueue )->ucQueueNumber = trace_queue_create()
+	#define traceCREATE_MUTEX( pxNewQueue )				( pxNewQueue )->ucQueueNumber = trace_queue_create()
+	#define traceQUEUE_SEND( pxQueue )					trace_queue( TRACE_QUEUE_SEND, ( pxQueue )->ucQueueNumber )
+	#define traceQUEUE_SEND_FROM_ISR( pxQueue )			trace_queue( TRACE_QUEUE_SEND, ( pxQueue )->ucQueueNumber )
+	#define traceQUEUE_RECEIVE( pxQueue )				trace_queue( TRACE_QUEUE_RECEIVE, ( pxQueue )->ucQueueNumber )
+	#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )		trace_queue( TRACE_QUEUE_RECEIVE, ( pxQueue )->ucQueueNumber )
+	#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )		trace_queue( TRACE_QUEUE_BLOCK_SEND, ( pxQueue )->ucQueueNumber )
+	#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	trace_queue( TRACE_QUEUE_BLOCK_RECEIVE, ( pxQueue )->ucQueueNumber )
+	#define traceISR_ENTER()							trace_isr_enter()
+	#define traceRECORD_MALLOC( pvAddress, uiSize )		trace_heap( TRACE_MALLOC, pvAddress, uiSize )
+	#define traceRECORD_FREE( pvAddress, uiSize )		trace_heap( TRACE_FREE, pvAddress, uiSize )
+#else
+	#define traceRECORD_MALLOC( pvAddress, uiSize )
+	#define traceRECORD_FREE( pvAddress, uiSize )
+#endif
+
+/* Heap ownership accounting for the "heap" command, see heapstat/heapstat.h.
+A tracked block costs 8 bytes and an owner slot 12, at the sizes below that is
+the 512 bytes the heap gave up above. */
+#define configUSE_HEAP_ACCOUNTING		1
+#define configHEAPSTAT_BLOCKS			24
+#define configHEAPSTAT_CALLERS			12
+#define configHEAPSTAT_TASKS			8
+
+#if configUSE_HEAP_ACCOUNTING == 1
+	#include "heapstat/heapstat.h"
+
+	/* Expanded inside pvPortMalloc(), so this is its caller, unless a wrapper
+	named its own caller just before. */
+	#define heapstatMALLOC( pvAddress, uiSize )			heapstat_malloc( pvAddress, uiSize, __builtin_return_address( 0 ) )
+	#define heapstatFREE( pvAddress, uiSize )			heapstat_free( pvAddress, uiSize )
+	#define traceMALLOC_ON_BEHALF_OF( pvCaller )		heapstat_on_behalf_of( pvCaller )
+#else
+	#define heapstatMALLOC( pvAddress, uiSize )
+	#define heapstatFREE( pvAddress, uiSize )
+#endif
+
+/* The heap hooks feed both of the above. */
+#define traceMALLOC( pvAddress, uiSize )	do { traceRECORD_MALLOC( pvAddress, uiSize ); heapstatMALLOC( pvAddress, uiSize ); } while( 0 )
+#define traceFREE( pvAddress, uiSize )		do { traceRECORD_FREE( pvAddress, uiSize ); heapstatFREE( pvAddress, uiSize ); } while( 0 )
+
+/* External SRAM on the FSMC, added to the heap as a slow region when built
+with HEAP_TYPE=heap_5; the board code must have the FSMC set up before main()
+(the P103 has none).  Allocations of up to configHEAP_FAST_ALLOCATION_LIMIT
+bytes prefer the internal SRAM, larger ones the external. */
+/* #define configEXTERNAL_SRAM_BASE		( ( unsigned char * ) 0x60000000 ) */
+/* #define configEXTERNAL_SRAM_SIZE		( 512 * 1024 ) */
+#define configHEAP_FAST_ALLOCATION_LIMIT	256
+
+/* Let the application hand in the memory for tasks, queues, semaphores and
+timers (the ...Static() create functions).  The shell task is laid out that
+way, its 2K stack is the 2048 bytes the heap gave up above. */
+#define configSUPPORT_STATIC_ALLOCATION	1
+
+/* Kernel objects drawn from fixed size block pools rather than the heap, sized
+for the idle and bench tasks.  The pools take about the 1280 bytes the
+heap gave up above. */
+#define configTCB_POOL_SIZE			3
+#define configQUEUE_POOL_SIZE		4
+#define configSTACK_POOL_SIZE		1
+#define configSTACK_POOL_DEPTH		configMINIMAL_STACK_SIZE
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
@@ -101,6 +189,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_xTaskGetSchedulerState	1
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
 (lowest) to 0 (1?) (highest). */
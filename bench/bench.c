@@ -0,0 +1,422 @@
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "fio.h"
+#include "bench.h"
+#include "shell.h"
+
+#define BENCH_ITERATIONS 200
+#define BENCH_PRIORITY (tskIDLE_PRIORITY + 2)
+#define BENCH_STACK_SIZE (configMINIMAL_STACK_SIZE * 2)
+
+/* Cycle counter and test interrupt ---------------------------------------*/
+
+#if defined(__arm__)
+#include "stm32f10x.h"
+
+#define benchDEMCR         ((volatile unsigned long *) 0xE000EDFC)
+#define benchDWT_CTRL      ((volatile unsigned long *) 0xE0001000)
+#define benchDWT_CYCCNT    ((volatile unsigned long *) 0xE0001004)
+#define benchDEMCR_TRCENA  0x01000000
+#define benchDWT_CYCCNTENA 0x00000001
+
+/* Emulators may not model the DWT, fall back to SysTick then. */
+static int use_dwt = 0;
+
+static void bench_isr(void);
+
+void bench_counter_init(void)
+{
+    unsigned long start;
+    volatile int i;
+
+    *benchDEMCR |= benchDEMCR_TRCENA;
+    *benchDWT_CYCCNT = 0;
+    *benchDWT_CTRL |= benchDWT_CYCCNTENA;
+
+    start = *benchDWT_CYCCNT;
+    for (i = 0; i < 100; i++);
+    use_dwt = *benchDWT_CYCCNT != start;
+}
+
+unsigned long bench_counter(void)
+{
+    portTickType tick;
+    unsigned long val;
+
+    if (use_dwt)
+        return *benchDWT_CYCCNT;
+
+    /* Ticks elapsed times the reload period, plus the SysTick down count. */
+    do {
+        tick = xTaskGetTickCount();
+        val = SysTick->VAL;
+    } while (tick != xTaskGetTickCount());
+
+    return tick * (SysTick->LOAD + 1) + (SysTick->LOAD - val);
+}
+
+const char * bench_counter_unit(void)
+{
+    return use_dwt ? "cycles (DWT)" : "cycles (SysTick)";
+}
+
+/* EXTI1 is not wired to anything on the board, so it is free to be pended
+ * from software as the test interrupt. */
+void EXTI1_IRQHandler()
+{
+    bench_isr();
+}
+
+static void bench_irq_init(void)
+{
+    NVIC_SetPriority(EXTI1_IRQn, 0x0F);
+    NVIC_EnableIRQ(EXTI1_IRQn);
+}
+
+static void bench_irq_trigger(void)
+{
+    NVIC_SetPendingIRQ(EXTI1_IRQn);
+}
+
+static void bench_irq_deinit(void)
+{
+    NVIC_DisableIRQ(EXTI1_IRQn);
+}
+#else
+#include <time.h>
+
+static void bench_isr(void);
+
+void bench_counter_init(void)
+{
+}
+
+unsigned long bench_counter(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+const char * bench_counter_unit(void)
+{
+    return "ns";
+}
+
+static void bench_irq_init(void)
+{
+    vPortSetInterruptHandler(bench_isr);
+}
+
+static void bench_irq_trigger(void)
+{
+    vPortGenerateSimulatedInterrupt();
+}
+
+static void bench_irq_deinit(void)
+{
+    vPortSetInterruptHandler(NULL);
+}
+#endif
+
+/* Statistics -------------------------------------------------------------*/
+
+void bench_stat_reset(struct bench_stat * s)
+{
+    s->min = (unsigned long) -1;
+    s->max = 0;
+    s->sum = 0;
+    s->count = 0;
+}
+
+void bench_stat_add(struct bench_stat * s, unsigned long v)
+{
+    if (v < s->min)
+        s->min = v;
+    if (v > s->max)
+        s->max = v;
+    s->sum += v;
+    s->count++;
+}
+
+void bench_stat_print(const char * name, struct bench_stat * s)
+{
+    if (!s->count) {
+        printf("%s\tno samples\r\n", name);
+        return;
+    }
+    printf("%s\tmin %u\tavg %u\tmax %u\r\n", name,
+           (unsigned) s->min, (unsigned) (s->sum / s->count), (unsigned) s->max);
+}
+
+/* State shared with the partner tasks ------------------------------------*/
+
+static xQueueHandle ping_queue;
+static xQueueHandle pong_queue;
+static xSemaphoreHandle bench_mutex;
+static xSemaphoreHandle start_sem;
+static volatile unsigned long t_end;
+static volatile xTaskHandle notify_task;
+
+/* taskYIELD round trip ---------------------------------------------------*/
+
+static void yield_partner(void * pvParameters)
+{
+    for (;;)
+        taskYIELD();
+}
+
+static int bench_yield(struct bench_stat * s)
+{
+    xTaskHandle partner;
+    unsigned long t0;
+    int i;
+
+    /* Same priority: every yield runs the partner, which yields back. */
+    if (xTaskCreate(yield_partner, (signed portCHAR *) "bYield",
+                    BENCH_STACK_SIZE, NULL, BENCH_PRIORITY, &partner) != pdPASS)
+        return -1;
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = bench_counter();
+        taskYIELD();
+        bench_stat_add(s, bench_counter() - t0);
+    }
+
+    vTaskDelete(partner);
+    return 0;
+}
+
+/* Queue send/receive ping-pong -------------------------------------------*/
+
+static void queue_partner(void * pvParameters)
+{
+    char c;
+
+    for (;;) {
+        xQueueReceive(ping_queue, &c, portMAX_DELAY);
+        xQueueSend(pong_queue, &c, portMAX_DELAY);
+    }
+}
+
+static int bench_queue(struct bench_stat * s)
+{
+    xTaskHandle partner;
+    unsigned long t0;
+    char c = 0;
+    int i;
+
+    ping_queue = xQueueCreate(1, sizeof(char));
+    pong_queue = xQueueCreate(1, sizeof(char));
+    if (!ping_queue || !pong_queue ||
+        xTaskCreate(queue_partner, (signed portCHAR *) "bQueue",
+                    BENCH_STACK_SIZE, NULL, BENCH_PRIORITY + 1, &partner) != pdPASS) {
+        if (ping_queue)
+            vQueueDelete(ping_queue);
+        if (pong_queue)
+            vQueueDelete(pong_queue);
+        return -1;
+    }
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = bench_counter();
+        xQueueSend(ping_queue, &c, portMAX_DELAY);
+        xQueueReceive(pong_queue, &c, portMAX_DELAY);
+        bench_stat_add(s, bench_counter() - t0);
+    }
+
+    vTaskDelete(partner);
+    vQueueDelete(ping_queue);
+    vQueueDelete(pong_queue);
+    return 0;
+}
+
+/* Mutex hand-over with priority inheritance ------------------------------*/
+
+static void mutex_partner(void * pvParameters)
+{
+    for (;;) {
+        xSemaphoreTake(start_sem, portMAX_DELAY);
+        /* Blocks, raising the holder (the bench task) to our priority. */
+        xSemaphoreTake(bench_mutex, portMAX_DELAY);
+        t_end = bench_counter();
+        xSemaphoreGive(bench_mutex);
+    }
+}
+
+static int bench_mutex_pi(struct bench_stat * s)
+{
+    xTaskHandle partner;
+    unsigned long t0;
+    int i;
+
+    bench_mutex = xSemaphoreCreateMutex();
+    vSemaphoreCreateBinary(start_sem);
+    if (start_sem)
+        xSemaphoreTake(start_sem, 0);
+    if (!bench_mutex || !start_sem ||
+        xTaskCreate(mutex_partner, (signed portCHAR *) "bMutex",
+                    BENCH_STACK_SIZE, NULL, BENCH_PRIORITY + 1, &partner) != pdPASS) {
+        if (bench_mutex)
+            vQueueDelete(bench_mutex);
+        if (start_sem)
+            vQueueDelete(start_sem);
+        return -1;
+    }
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        xSemaphoreTake(bench_mutex, portMAX_DELAY);
+        xSemaphoreGive(start_sem);
+        /* The partner is now blocked on the mutex.  Measure from the give
+         * (disinheritance and switch) until the partner owns it. */
+        t0 = bench_counter();
+        xSemaphoreGive(bench_mutex);
+        bench_stat_add(s, t_end - t0);
+    }
+
+    vTaskDelete(partner);
+    vQueueDelete(bench_mutex);
+    vQueueDelete(start_sem);
+    return 0;
+}
+
+/* ISR to task wakeup -----------------------------------------------------*/
+
+static void bench_isr(void)
+{
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    char c = 0;
+
+    traceISR_ENTER();
+
+    if (notify_task)
+        vTaskNotifyGiveFromISR(notify_task, &xHigherPriorityTaskWoken);
+    else
+        xQueueSendFromISR(ping_queue, &c, &xHigherPriorityTaskWoken);
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+/* pvParameters is non-NULL to wait for a notification instead of the queue. */
+static void isr_partner(void * pvParameters)
+{
+    char c;
+
+    for (;;) {
+        if (pvParameters)
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        else
+            xQueueReceive(ping_queue, &c, portMAX_DELAY);
+        t_end = bench_counter();
+    }
+}
+
+/* Wake the partner through a one item queue, or with a direct task
+ * notification when use_notify is set. */
+static int bench_isr_wakeup(struct bench_stat * s, int use_notify)
+{
+    xTaskHandle partner;
+    unsigned long t0;
+    int i;
+
+    ping_queue = xQueueCreate(1, sizeof(char));
+    if (!ping_queue ||
+        xTaskCreate(isr_partner, (signed portCHAR *) "bISR",
+                    BENCH_STACK_SIZE, use_notify ? (void *) 1 : NULL,
+                    BENCH_PRIORITY + 1, &partner) != pdPASS) {
+        if (ping_queue)
+            vQueueDelete(ping_queue);
+        return -1;
+    }
+    notify_task = use_notify ? partner : NULL;
+    bench_irq_init();
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t_end = 0;
+        t0 = bench_counter();
+        bench_irq_trigger();
+        /* The partner preempts us on the way out of the interrupt. */
+        while (!t_end)
+            taskYIELD();
+        bench_stat_add(s, t_end - t0);
+    }
+
+    bench_irq_deinit();
+    notify_task = NULL;
+    vTaskDelete(partner);
+    vQueueDelete(ping_queue);
+    return 0;
+}
+
+/* vTaskDelay period ------------------------------------------------------*/
+
+static void bench_delay(struct bench_stat * s)
+{
+    unsigned long t0, t1;
+    int i;
+
+    /* Start on a tick boundary. */
+    vTaskDelay(1);
+    t0 = bench_counter();
+    for (i = 0; i < BENCH_ITERATIONS / 4; i++) {
+        vTaskDelay(1);
+        t1 = bench_counter();
+        bench_stat_add(s, t1 - t0);
+        t0 = t1;
+    }
+}
+
+static void bench_report(const char * name, struct bench_stat * s, int ret)
+{
+    if (ret < 0)
+        printf("%s\tOut of memory\r\n", name);
+    else
+        bench_stat_print(name, s);
+}
+
+void bench_run(void)
+{
+    struct bench_stat s;
+    unsigned portBASE_TYPE priority = uxTaskPriorityGet(NULL);
+
+    /* Leave room above us for the partner tasks that must preempt. */
+    vTaskPrioritySet(NULL, BENCH_PRIORITY);
+    bench_counter_init();
+
+    printf("%d iterations, unit: %s\r\n", BENCH_ITERATIONS, bench_counter_unit());
+
+    bench_stat_reset(&s);
+    bench_report("taskYIELD round trip\t", &s, bench_yield(&s));
+
+    bench_stat_reset(&s);
+    bench_report("queue ping-pong\t\t", &s, bench_queue(&s));
+
+    bench_stat_reset(&s);
+    bench_report("mutex give (inherited)\t", &s, bench_mutex_pi(&s));
+
+    bench_stat_reset(&s);
+    bench_report("ISR to task (queue)\t", &s, bench_isr_wakeup(&s, 0));
+
+    bench_stat_reset(&s);
+    bench_report("ISR to task (notify)\t", &s, bench_isr_wakeup(&s, 1));
+
+    bench_stat_reset(&s);
+    bench_delay(&s);
+    bench_stat_print("vTaskDelay(1) period\t", &s);
+    printf("(one tick is %d ms)\r\n", portTICK_RATE_MS);
+
+    vTaskPrioritySet(NULL, priority);
+}
+
+static void bench_command(int argc, char *argv[])
+{
+    bench_run();
+}
+
+SHELL_COMMAND(bench, bench_command, "Run kernel latency benchmarks");
@@ -0,0 +1,26 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+/* Kernel micro-benchmarks: context switch, queue, mutex, ISR wakeup and
+ * vTaskDelay jitter.  Prints min/avg/max per operation in counter units
+ * (CPU cycles on the target, nanoseconds on the host build). */
+void bench_run(void);
+
+/* Free-running counter used for the measurements. */
+void bench_counter_init(void);
+unsigned long bench_counter(void);
+const char * bench_counter_unit(void);
+
+/* Running min/avg/max of counter deltas. */
+struct bench_stat {
+    unsigned long min;
+    unsigned long max;
+    unsigned long sum;
+    unsigned int count;
+};
+
+void bench_stat_reset(struct bench_stat * s);
+void bench_stat_add(struct bench_stat * s, unsigned long v);
+void bench_stat_print(const char * name, struct bench_stat * s);
+
+#endif
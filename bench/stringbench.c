@@ -0,0 +1,380 @@
+/* Host side check and benchmark for the string-util.c routines.  The
+ * Makefile builds string-util.c with every function renamed to su_*, so
+ * both versions live in one process: the mem* routines are run against
+ * glibc over every size and alignment combination, the str* ones on random
+ * strings and alignments, then all are timed on a few sizes.
+ *
+ * Usage: stringbench [fuzz iterations [seed]] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+void *su_memset(void *dest, int c, size_t n);
+void *su_memcpy(void *dest, const void *src, size_t n);
+void *su_memmove(void *dest, const void *src, size_t n);
+int su_memcmp(const void *vl, const void *vr, size_t n);
+char *su_strchr(const char *s, int c);
+char *su_strcpy(char *dest, const char *src);
+char *su_strncpy(char *dest, const char *src, size_t n);
+size_t su_strlen(const char *s);
+int su_strcmp(const char *s1, const char *s2);
+int su_strncmp(const char *s1, const char *s2, size_t n);
+char *su_strcat(char *dest, const char *src);
+size_t su_strlcpy(char *dest, const char *src, size_t size);
+size_t su_strlcat(char *dest, const char *src, size_t size);
+
+#define MAX_SIZE  300           /* sizes 0..MAX_SIZE are checked */
+#define MAX_ALIGN 16            /* offsets 0..MAX_ALIGN-1 on each side */
+#define GUARD     32            /* bytes checked around the destination */
+#define BUF_SIZE  (2 * GUARD + MAX_ALIGN + 2 * MAX_SIZE)
+
+static unsigned char src_buf[BUF_SIZE], dst_buf[BUF_SIZE], ref_buf[BUF_SIZE];
+static int failures;
+
+static void fail(const char *name, size_t n, int a, int b)
+{
+    if (failures++ < 20)
+        printf("FAIL %s n=%zu align=%d,%d\n", name, n, a, b);
+}
+
+static void fill(unsigned char *p, size_t n, unsigned seed)
+{
+    while (n--)
+        *p++ = (seed = seed * 1103515245 + 12345) >> 16;
+}
+
+static int sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+/* Correctness ------------------------------------------------------------*/
+
+static void check_memcpy(void)
+{
+    size_t n;
+    int a, b;
+
+    for (n = 0; n <= MAX_SIZE; n++)
+        for (a = 0; a < MAX_ALIGN; a++)
+            for (b = 0; b < MAX_ALIGN; b++) {
+                fill(src_buf, BUF_SIZE, n + a);
+                fill(dst_buf, BUF_SIZE, b);
+                memcpy(ref_buf, dst_buf, BUF_SIZE);
+                memcpy(ref_buf + GUARD + b, src_buf + a, n);
+                if (su_memcpy(dst_buf + GUARD + b, src_buf + a, n) != dst_buf + GUARD + b ||
+                    memcmp(dst_buf, ref_buf, BUF_SIZE))
+                    fail("memcpy", n, a, b);
+            }
+}
+
+static void check_memmove(void)
+{
+    size_t n;
+    int a, b;
+
+    /* Both ends in one buffer, overlapping in either direction. */
+    for (n = 0; n <= MAX_SIZE; n++)
+        for (a = 0; a < MAX_ALIGN; a++)
+            for (b = 0; b < MAX_ALIGN; b++) {
+                int from = GUARD + a, to = GUARD + b + (n & 1 ? 0 : MAX_ALIGN);
+
+                fill(dst_buf, BUF_SIZE, n + a + b);
+                memcpy(ref_buf, dst_buf, BUF_SIZE);
+                memmove(ref_buf + to, ref_buf + from, n);
+                if (su_memmove(dst_buf + to, dst_buf + from, n) != dst_buf + to ||
+                    memcmp(dst_buf, ref_buf, BUF_SIZE))
+                    fail("memmove", n, from, to);
+
+                fill(dst_buf, BUF_SIZE, n + a + b);
+                memcpy(ref_buf, dst_buf, BUF_SIZE);
+                memmove(ref_buf + from, ref_buf + to, n);
+                if (su_memmove(dst_buf + from, dst_buf + to, n) != dst_buf + from ||
+                    memcmp(dst_buf, ref_buf, BUF_SIZE))
+                    fail("memmove", n, to, from);
+            }
+}
+
+static void check_memcmp(void)
+{
+    size_t n, i;
+    int a, b;
+
+    for (n = 0; n <= MAX_SIZE; n++)
+        for (a = 0; a < MAX_ALIGN; a++)
+            for (b = 0; b < MAX_ALIGN; b++) {
+                fill(src_buf + a, n, n);
+                fill(dst_buf + b, n, n);
+                if (su_memcmp(src_buf + a, dst_buf + b, n))
+                    fail("memcmp equal", n, a, b);
+                /* A difference at the first, a middle and the last byte,
+                 * both ways round so the byte order matters. */
+                for (i = 0; i < n; i += n / 2 ? n / 2 : 1) {
+                    dst_buf[b + i] ^= 0x81;
+                    if (sign(su_memcmp(src_buf + a, dst_buf + b, n)) !=
+                        sign(memcmp(src_buf + a, dst_buf + b, n)) ||
+                        sign(su_memcmp(dst_buf + b, src_buf + a, n)) !=
+                        sign(memcmp(dst_buf + b, src_buf + a, n)))
+                        fail("memcmp", n, a, b);
+                    dst_buf[b + i] ^= 0x81;
+                }
+            }
+}
+
+static void check_memset(void)
+{
+    size_t n;
+    int b;
+
+    for (n = 0; n <= MAX_SIZE; n++)
+        for (b = 0; b < MAX_ALIGN; b++) {
+            fill(dst_buf, BUF_SIZE, n + b);
+            memcpy(ref_buf, dst_buf, BUF_SIZE);
+            memset(ref_buf + GUARD + b, 0xA5 + n, n);
+            if (su_memset(dst_buf + GUARD + b, 0xA5 + n, n) != dst_buf + GUARD + b ||
+                memcmp(dst_buf, ref_buf, BUF_SIZE))
+                fail("memset", n, 0, b);
+        }
+}
+
+/* String fuzzing ---------------------------------------------------------*/
+
+#define FUZZ_LEN 300            /* longest string */
+
+enum { FUZZ_STRLEN, FUZZ_STRCHR, FUZZ_STRCMP, FUZZ_STRNCMP, FUZZ_STRCPY,
+       FUZZ_STRNCPY, FUZZ_STRCAT, FUZZ_STRLCPY, FUZZ_STRLCAT, FUZZ_OPS };
+
+static const char *fuzz_names[FUZZ_OPS] = {
+    "strlen", "strchr", "strcmp", "strncmp", "strcpy",
+    "strncpy", "strcat", "strlcpy", "strlcat",
+};
+
+static unsigned rnd_state;
+
+static unsigned rnd(unsigned n)
+{
+    rnd_state = rnd_state * 1103515245 + 12345;
+    return (rnd_state >> 8) % n;
+}
+
+/* Few distinct letters so compared strings share long prefixes, and
+ * bytes above 0x7f to catch signed char comparisons. */
+static char rnd_char(void)
+{
+    static const char alphabet[] = "ab\x7f\x80\xff";
+
+    return alphabet[rnd(sizeof(alphabet) - 1)];
+}
+
+static char *rnd_string(unsigned char *buf, size_t len)
+{
+    char *s = (char *)buf + rnd(MAX_ALIGN);
+    size_t i;
+
+    /* Random bytes after the terminator, zeros included. */
+    fill(buf, BUF_SIZE, rnd_state);
+    for (i = 0; i < len; i++)
+        s[i] = rnd_char();
+    s[len] = 0;
+    return s;
+}
+
+static size_t ref_strlcat(char *dest, const char *src, size_t size)
+{
+    size_t len = strnlen(dest, size);
+
+    if (len == size)
+        return size + strlen(src);
+    return len + snprintf(dest + len, size - len, "%s", src);
+}
+
+static void fuzz_one(void)
+{
+    unsigned op = rnd(FUZZ_OPS);
+    size_t len = rnd(FUZZ_LEN), n = rnd(FUZZ_LEN + 16);
+    int c = rnd(8) ? rnd_char() : 0;
+    char *s = rnd_string(src_buf, len), *d, *r;
+    long ours = 0, ref = 0;
+
+    /* Second string: a copy of the first, possibly cut short or with one
+     * byte changed, or a prefix of the destination for the concatenations. */
+    d = rnd_string(dst_buf, op == FUZZ_STRCAT || op == FUZZ_STRLCAT ? rnd(FUZZ_LEN) : 0);
+    if (op == FUZZ_STRCMP || op == FUZZ_STRNCMP) {
+        strcpy(d, s);
+        if (len && rnd(4)) {
+            size_t at = rnd(len);
+
+            d[at] = rnd(2) ? 0 : rnd_char();
+        }
+    }
+    memcpy(ref_buf, dst_buf, BUF_SIZE);
+    r = (char *)ref_buf + (d - (char *)dst_buf);
+
+    switch (op) {
+    case FUZZ_STRLEN:
+        ours = su_strlen(s);
+        ref = strlen(s);
+        break;
+    case FUZZ_STRCHR:
+        ours = su_strchr(s, c) ? su_strchr(s, c) - s : -1;
+        ref = strchr(s, c) ? strchr(s, c) - s : -1;
+        break;
+    case FUZZ_STRCMP:
+        ours = sign(su_strcmp(s, d)) + 3 * sign(su_strcmp(d, s));
+        ref = sign(strcmp(s, d)) + 3 * sign(strcmp(d, s));
+        break;
+    case FUZZ_STRNCMP:
+        ours = sign(su_strncmp(s, d, n)) + 3 * sign(su_strncmp(d, s, n));
+        ref = sign(strncmp(s, d, n)) + 3 * sign(strncmp(d, s, n));
+        break;
+    case FUZZ_STRCPY:
+        ours = su_strcpy(d, s) - d;
+        ref = strcpy(r, s) - r;
+        break;
+    case FUZZ_STRNCPY:
+        ours = su_strncpy(d, s, n) - d;
+        ref = strncpy(r, s, n) - r;
+        break;
+    case FUZZ_STRCAT:
+        ours = su_strcat(d, s) - d;
+        ref = strcat(r, s) - r;
+        break;
+    case FUZZ_STRLCPY:
+        ours = su_strlcpy(d, s, n);
+        ref = n ? snprintf(r, n, "%s", s) : (int)strlen(s);
+        break;
+    case FUZZ_STRLCAT:
+        ours = su_strlcat(d, s, n);
+        ref = ref_strlcat(r, s, n);
+        break;
+    }
+
+    if (ours != ref || memcmp(dst_buf, ref_buf, BUF_SIZE))
+        fail(fuzz_names[op], len, (int)(s - (char *)src_buf), (int)(d - (char *)dst_buf));
+}
+
+/* Throughput -------------------------------------------------------------*/
+
+#define BENCH_BYTES (64 << 20)  /* copied per measurement */
+
+static unsigned char big_src[4096 + 16], big_dst[4096 + 16];
+
+typedef void *(*copy_fn)(void *, const void *, size_t);
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double copy_rate(copy_fn fn, size_t n, int a, int b)
+{
+    /* Calls through a volatile pointer so glibc's copy is not inlined. */
+    copy_fn volatile call = fn;
+    size_t i, loops = BENCH_BYTES / n;
+    double start = now();
+
+    for (i = 0; i < loops; i++)
+        call(big_dst + b, big_src + a, n);
+    return loops * n / (now() - start) / (1 << 20);
+}
+
+static void bench_copy(const char *name, copy_fn ours, copy_fn libc)
+{
+    static const size_t sizes[] = { 8, 16, 64, 256, 1024, 4096 };
+    static const int aligns[][2] = { { 0, 0 }, { 1, 1 }, { 0, 3 }, { 3, 0 }, { 1, 2 } };
+    unsigned i, j;
+
+    printf("\n%-8s  size  src,dst   ours MB/s   glibc MB/s\n", name);
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        for (j = 0; j < sizeof(aligns) / sizeof(aligns[0]); j++)
+            printf("%14zu  %3d,%-3d %11.0f %12.0f\n", sizes[i], aligns[j][0], aligns[j][1],
+                   copy_rate(ours, sizes[i], aligns[j][0], aligns[j][1]),
+                   copy_rate(libc, sizes[i], aligns[j][0], aligns[j][1]));
+}
+
+/* One wrapper shape for all the string routines. */
+typedef size_t (*str_fn)(char *d, const char *s, size_t n);
+
+static size_t ours_strlen(char *d, const char *s, size_t n) { return su_strlen(s); }
+static size_t libc_strlen(char *d, const char *s, size_t n) { return strlen(s); }
+static size_t ours_strchr(char *d, const char *s, size_t n) { return (size_t)su_strchr(s, '!'); }
+static size_t libc_strchr(char *d, const char *s, size_t n) { return (size_t)strchr(s, '!'); }
+static size_t ours_strcmp(char *d, const char *s, size_t n) { return su_strcmp(d, s); }
+static size_t libc_strcmp(char *d, const char *s, size_t n) { return strcmp(d, s); }
+static size_t ours_strncmp(char *d, const char *s, size_t n) { return su_strncmp(d, s, n); }
+static size_t libc_strncmp(char *d, const char *s, size_t n) { return strncmp(d, s, n); }
+static size_t ours_strcpy(char *d, const char *s, size_t n) { return (size_t)su_strcpy(d, s); }
+static size_t libc_strcpy(char *d, const char *s, size_t n) { return (size_t)strcpy(d, s); }
+static size_t ours_strlcpy(char *d, const char *s, size_t n) { return su_strlcpy(d, s, n + 1); }
+static size_t libc_strlcpy(char *d, const char *s, size_t n) { return snprintf(d, n + 1, "%s", s); }
+
+static double str_rate(str_fn fn, size_t n, int a, int b)
+{
+    str_fn volatile call = fn;
+    size_t i, loops = BENCH_BYTES / 4 / (n + 1);
+    double start = now();
+
+    for (i = 0; i < loops; i++)
+        call((char *)big_dst + b, (const char *)big_src + a, n);
+    return loops * n / (now() - start) / (1 << 20);
+}
+
+static void bench_str(const char *name, str_fn ours, str_fn libc, int copies)
+{
+    static const size_t sizes[] = { 8, 64, 1024 };
+    static const int aligns[][2] = { { 0, 0 }, { 3, 3 }, { 1, 2 } };
+    unsigned i, j;
+
+    printf("\n%-8s  size  src,dst   ours MB/s   glibc MB/s\n", name);
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        for (j = 0; j < sizeof(aligns) / sizeof(aligns[0]); j++) {
+            int a = aligns[j][0], b = aligns[j][1];
+
+            /* The same string on both sides for the compares, the
+             * copies overwrite the destination every call. */
+            memset(big_src + a, 'x', sizes[i]);
+            big_src[a + sizes[i]] = 0;
+            if (!copies)
+                memcpy(big_dst + b, big_src + a, sizes[i] + 1);
+            printf("%14zu  %3d,%-3d %11.0f %12.0f\n", sizes[i], a, b,
+                   str_rate(ours, sizes[i], a, b), str_rate(libc, sizes[i], a, b));
+        }
+}
+
+int main(int argc, char **argv)
+{
+    long i, iterations = argc > 1 ? atol(argv[1]) : 1000000;
+
+    rnd_state = argc > 2 ? atol(argv[2]) : 1;
+
+    check_memcpy();
+    check_memmove();
+    check_memcmp();
+    check_memset();
+    printf("mem*: %s (%d failures)\n", failures ? "FAIL" : "ok", failures);
+
+    for (i = 0; i < iterations; i++)
+        fuzz_one();
+    printf("str*: %s after %ld random calls (%d failures)\n",
+           failures ? "FAIL" : "ok", iterations, failures);
+    if (failures)
+        return 1;
+
+    fill(big_src, sizeof(big_src), 1);
+    bench_copy("memcpy", su_memcpy, memcpy);
+    bench_copy("memmove", su_memmove, memmove);
+
+    bench_str("strlen", ours_strlen, libc_strlen, 0);
+    bench_str("strchr", ours_strchr, libc_strchr, 0);
+    bench_str("strcmp", ours_strcmp, libc_strcmp, 0);
+    bench_str("strncmp", ours_strncmp, libc_strncmp, 0);
+    bench_str("strcpy", ours_strcpy, libc_strcpy, 1);
+    bench_str("strlcpy", ours_strlcpy, libc_strlcpy, 1);
+
+    return 0;
+}
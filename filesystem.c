@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <hash-djb2.h>
+#include "romfs.h"
 
 #define MAX_FS 16
 
@@ -61,7 +62,7 @@ int fs_open(const char * path, int flags, int mode) {
     return -2;
 }
 
-int getAllFileName(const char * path, char* buff)
+int getAllFileName(const char * path, char* buff, size_t size)
 {
     const char * slash;
     uint32_t hash;
@@ -82,8 +83,8 @@ int getAllFileName(const char * path, char* buff)
         if (fss[i].hash == hash)
         {
             int count=0;
-            const uint8_t * romfs = fss[i].opaque;
-            while(romfs=getNextFileName(romfs,buff))
+            const uint8_t * romfs = romfs_get_entries(fss[i].opaque);
+            while(romfs=getNextFileName(romfs,buff,size))
                 count++;
             return count;
         }
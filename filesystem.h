@@ -2,6 +2,7 @@
 #define __FILESYSTEM_H__
 
 #include <stdint.h>
+#include <stddef.h>
 #include <hash-djb2.h>
 
 #define MAX_FS 16
@@ -13,6 +14,6 @@ __attribute__((constructor)) void fs_init();
 
 int register_fs(const char * mountpoint, fs_open_t callback, void * opaque);
 int fs_open(const char * path, int flags, int mode);
-int getAllFileName(const char * path, char* buff);
+int getAllFileName(const char * path, char* buff, size_t size);
 
 #endif
@@ -0,0 +1,98 @@
+#include <string.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include "fio.h"
+#include "fio-pipe.h"
+
+/* Each side only moves its own index, and reads the other one whole, so
+ * the ring needs no lock.  The semaphores carry the wakeups: a give that
+ * comes before the take is kept, so none is lost. */
+
+static ssize_t fio_pipe_read(void * opaque, void * buf, size_t count) {
+    struct fio_pipe * p = (struct fio_pipe *) opaque;
+    size_t n, off, first;
+
+    while (p->head == p->tail) {
+        /* The writer may fill the ring and close between the two loads,
+         * so look at the ring again once it is known to be closed. */
+        if (!p->writing && p->head == p->tail)
+            return 0;
+        xSemaphoreTake(p->data, portMAX_DELAY);
+    }
+
+    n = p->head - p->tail;
+    if (n > count)
+        n = count;
+    off = p->tail & (p->size - 1);
+    first = p->size - off < n ? p->size - off : n;
+    memcpy(buf, p->buf + off, first);
+    memcpy((char *) buf + first, p->buf, n - first);
+    p->tail += n;
+    xSemaphoreGive(p->space);
+
+    return n;
+}
+
+static ssize_t fio_pipe_write(void * opaque, const void * buf, size_t count) {
+    struct fio_pipe * p = (struct fio_pipe *) opaque;
+    const char * data = (const char *) buf;
+    size_t done = 0, n, off, first;
+
+    while (done < count) {
+        if (!p->reading)
+            return done ? (ssize_t) done : -1;
+
+        n = p->size - (p->head - p->tail);
+        if (!n) {
+            xSemaphoreTake(p->space, portMAX_DELAY);
+            continue;
+        }
+        if (n > count - done)
+            n = count - done;
+        off = p->head & (p->size - 1);
+        first = p->size - off < n ? p->size - off : n;
+        memcpy(p->buf + off, data + done, first);
+        memcpy(p->buf, data + done + first, n - first);
+        p->head += n;
+        done += n;
+        xSemaphoreGive(p->data);
+    }
+
+    return done;
+}
+
+static int fio_pipe_close_read(void * opaque) {
+    struct fio_pipe * p = (struct fio_pipe *) opaque;
+
+    p->reading = 0;
+    xSemaphoreGive(p->space);
+    return 0;
+}
+
+static int fio_pipe_close_write(void * opaque) {
+    struct fio_pipe * p = (struct fio_pipe *) opaque;
+
+    p->writing = 0;
+    xSemaphoreGive(p->data);
+    return 0;
+}
+
+int fio_pipe(struct fio_pipe * p, char * buf, size_t size, int fd[2]) {
+    p->buf = buf;
+    p->size = size;
+    p->head = p->tail = 0;
+    p->reading = p->writing = 1;
+    p->data = xSemaphoreCreateBinaryStatic(&p->data_buffer);
+    p->space = xSemaphoreCreateBinaryStatic(&p->space_buffer);
+
+    fd[0] = fio_open(fio_pipe_read, NULL, NULL, fio_pipe_close_read, p);
+    if (fd[0] < 0)
+        return -1;
+    fd[1] = fio_open(NULL, fio_pipe_write, NULL, fio_pipe_close_write, p);
+    if (fd[1] < 0) {
+        fio_close(fd[0]);
+        return -1;
+    }
+
+    return 0;
+}
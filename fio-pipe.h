@@ -0,0 +1,29 @@
+#ifndef __FIO_PIPE_H__
+#define __FIO_PIPE_H__
+
+#include <stddef.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+/* Bounded byte pipes between two tasks, one writing and one reading, over
+ * a ring in the caller's memory.  A writer blocks while the ring is full
+ * and a reader while it is empty.  Once the write end is closed, reads
+ * return what is left and then 0.  Once the read end is closed, writes
+ * fail, so a producer whose consumer has finished stops instead of hanging. */
+
+struct fio_pipe {
+    char * buf;
+    size_t size;
+    volatile size_t head;           /* bytes written, free running */
+    volatile size_t tail;           /* bytes read */
+    volatile int reading, writing;  /* ends still open */
+    xSemaphoreHandle data, space;   /* given as either changes */
+    xStaticSemaphoreType data_buffer, space_buffer;
+};
+
+/* Sets p up over buf, size a power of two, and opens both ends, fd[0] for
+ * reading and fd[1] for writing.  Returns -1 when there are no descriptors
+ * left. */
+int fio_pipe(struct fio_pipe * p, char * buf, size_t size, int fd[2]);
+
+#endif
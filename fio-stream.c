@@ -0,0 +1,205 @@
+#include <string.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
+#include "fio.h"
+#include "fio-stream.h"
+#include "format.h"
+
+#define FIO_STDOUT_BUF_SIZE 80
+
+struct fio_stream fio_stdout_stream;
+static char fio_stdout_buf[FIO_STDOUT_BUF_SIZE];
+
+/* Run by fio_init(), the target does not run constructors. */
+void fio_stream_init() {
+    fio_fdopen(&fio_stdout_stream, 1, fio_stdout_buf, sizeof(fio_stdout_buf), FIO_LBF);
+}
+
+void fio_set_stdio(struct fio_stdio * io) {
+    vTaskSetApplicationTaskTag(NULL, (pdTASK_HOOK_CODE) io);
+}
+
+/* Output before the scheduler starts has no task to look at. */
+static struct fio_stdio * fio_get_stdio() {
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+        return NULL;
+    return (struct fio_stdio *) xTaskGetApplicationTaskTag(NULL);
+}
+
+int fio_stdin() {
+    struct fio_stdio * io = fio_get_stdio();
+
+    return io ? io->in : 0;
+}
+
+struct fio_stream * fio_task_stdout() {
+    struct fio_stdio * io = fio_get_stdio();
+
+    return io && io->out ? io->out : &fio_stdout_stream;
+}
+
+void fio_fdopen(struct fio_stream * s, int fd, char * buf, size_t size, int mode) {
+    s->fd = fd;
+    s->mode = buf && size ? mode : FIO_NBF;
+    s->buf = buf;
+    s->size = size;
+    s->len = 0;
+    s->lock = xSemaphoreCreateMutexStatic(&s->lock_buffer);
+}
+
+/* Called with the lock held. */
+static int fio_stream_drain(struct fio_stream * s, const char * buf, size_t count) {
+    ssize_t r;
+
+    while (count) {
+        r = fio_write(s->fd, buf, count);
+        if (r <= 0)
+            return -1;
+        buf += r;
+        count -= r;
+    }
+
+    return 0;
+}
+
+static int fio_stream_flush(struct fio_stream * s) {
+    int r = fio_stream_drain(s, s->buf, s->len);
+
+    s->len = 0;
+    return r;
+}
+
+/* Appends to the buffer, flushing it as it fills.  A write at least the
+ * size of an empty buffer goes straight to the driver. */
+static int fio_stream_put(struct fio_stream * s, const char * data, size_t count) {
+    size_t n;
+
+    if (s->mode == FIO_NBF)
+        return fio_stream_drain(s, data, count);
+
+    while (count) {
+        if (!s->len && count >= s->size)
+            return fio_stream_drain(s, data, count);
+
+        n = s->size - s->len;
+        if (n > count)
+            n = count;
+        memcpy(s->buf + s->len, data, n);
+        s->len += n;
+        data += n;
+        count -= n;
+
+        if (s->len == s->size && fio_stream_flush(s))
+            return -1;
+    }
+
+    return 0;
+}
+
+static int fio_stream_has_newline(const char * data, size_t count) {
+    while (count--)
+        if (*data++ == '\n')
+            return 1;
+    return 0;
+}
+
+int fio_fflush(struct fio_stream * s) {
+    int r;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    r = fio_stream_flush(s);
+    xSemaphoreGive(s->lock);
+
+    return r;
+}
+
+size_t fio_fwrite(const void * ptr, size_t size, size_t nmemb, struct fio_stream * s) {
+    size_t count = size * nmemb;
+    int r;
+
+    if (!count)
+        return 0;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    r = fio_stream_put(s, (const char *) ptr, count);
+    if (!r && s->mode == FIO_LBF && fio_stream_has_newline((const char *) ptr, count))
+        r = fio_stream_flush(s);
+    xSemaphoreGive(s->lock);
+
+    return r ? 0 : nmemb;
+}
+
+int fio_fputc(int c, struct fio_stream * s) {
+    char ch = c;
+
+    return fio_fwrite(&ch, 1, 1, s) ? (unsigned char) ch : -1;
+}
+
+int fio_fputs(const char * str, struct fio_stream * s) {
+    size_t len = strlen(str);
+
+    return !len || fio_fwrite(str, len, 1, s) ? 0 : -1;
+}
+
+/* Reads are not buffered, but anything written to the stream is sent
+ * first so a prompt shows before the read blocks. */
+size_t fio_fread(void * ptr, size_t size, size_t nmemb, struct fio_stream * s) {
+    size_t count = size * nmemb, got = 0;
+    ssize_t r;
+
+    if (!count)
+        return 0;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    fio_stream_flush(s);
+    while (got < count) {
+        r = fio_read(s->fd, (char *) ptr + got, count - got);
+        if (r <= 0)
+            break;
+        got += r;
+    }
+    xSemaphoreGive(s->lock);
+
+    return got / size;
+}
+
+struct fio_stream_format {
+    struct fio_stream * s;
+    int newline;
+    int error;
+};
+
+static void fio_stream_sink(void * opaque, const char * buf, size_t count) {
+    struct fio_stream_format * f = (struct fio_stream_format *) opaque;
+
+    if (f->error)
+        return;
+    if (fio_stream_put(f->s, buf, count))
+        f->error = 1;
+    if (!f->newline)
+        f->newline = fio_stream_has_newline(buf, count);
+}
+
+int fio_vfprintf(struct fio_stream * s, const char * fmt, va_list ap) {
+    struct fio_stream_format f = { s, 0, 0 };
+    int r;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    r = format_vprint(fio_stream_sink, &f, fmt, ap);
+    if (!f.error && s->mode == FIO_LBF && f.newline && fio_stream_flush(s))
+        f.error = 1;
+    xSemaphoreGive(s->lock);
+
+    return f.error ? -1 : r;
+}
+
+int fio_fprintf(struct fio_stream * s, const char * fmt, ...) {
+    va_list ap;
+    int r;
+
+    va_start(ap, fmt);
+    r = fio_vfprintf(s, fmt, ap);
+    va_end(ap);
+    return r;
+}
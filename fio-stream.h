@@ -0,0 +1,65 @@
+#ifndef __FIO_STREAM_H__
+#define __FIO_STREAM_H__
+
+#include <stddef.h>
+#include <stdarg.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+/* Buffered streams over fio descriptors, a small stdio.  Writes collect in
+ * the stream buffer and reach the driver in one fio_write() when it fills,
+ * when a line is complete (FIO_LBF) or on fio_fflush().  The names carry a
+ * fio_ prefix as the C library's stdio.h is in scope everywhere. */
+
+enum fio_buf_mode_t {
+    FIO_NBF,        /* unbuffered, every call goes to the driver */
+    FIO_LBF,        /* flushed after a write that holds a newline */
+    FIO_FBF,        /* flushed when full */
+};
+
+struct fio_stream {
+    int fd;
+    int mode;
+    char * buf;
+    size_t size;
+    size_t len;                 /* bytes waiting in buf */
+    xSemaphoreHandle lock;
+    xStaticSemaphoreType lock_buffer;
+};
+
+/* Line buffered stream on fd 1, the terminal. */
+extern struct fio_stream fio_stdout_stream;
+
+void fio_stream_init();
+
+/* Standard streams of a task, kept in its task tag.  The shell points them
+ * elsewhere while a command runs in a pipeline or with redirections, tasks
+ * without any use the terminal. */
+struct fio_stdio {
+    int in;                     /* fd */
+    struct fio_stream * out;
+};
+
+/* For the calling task, NULL goes back to the terminal. */
+void fio_set_stdio(struct fio_stdio * io);
+int fio_stdin();
+struct fio_stream * fio_task_stdout();
+
+/* The shell and log output. */
+#define fio_stdout (fio_task_stdout())
+
+/* Sets s up on fd with the caller's buffer, nothing is allocated. */
+void fio_fdopen(struct fio_stream * s, int fd, char * buf, size_t size, int mode);
+int fio_fflush(struct fio_stream * s);
+int fio_fputc(int c, struct fio_stream * s);
+int fio_fputs(const char * str, struct fio_stream * s);
+size_t fio_fwrite(const void * ptr, size_t size, size_t nmemb, struct fio_stream * s);
+size_t fio_fread(void * ptr, size_t size, size_t nmemb, struct fio_stream * s);
+
+/* Formats straight into the stream buffer, see format.h.  The whole output
+ * is written under the stream lock, so lines from different tasks do not
+ * interleave. */
+int fio_vfprintf(struct fio_stream * s, const char * fmt, va_list ap);
+int fio_fprintf(struct fio_stream * s, const char * fmt, ...);
+
+#endif
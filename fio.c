@@ -4,34 +4,39 @@
 #include <unistd.h>
 #include <stdarg.h>
 #include "fio.h"
+#include "fio-stream.h"
 #include "filesystem.h"
+#include "io_set_serial.h"
+#include "string-util.h"
 #include "osdebug.h"
 #include "hash-djb2.h"
+#include "bench/bench.h"
 
 static struct fddef_t fio_fds[MAX_FDS];
 
+/* Raw bytes from the serial port, no echo or line editing. */
 static ssize_t stdin_read(void * opaque, void * buf, size_t count) {
-    return 0;
+    if (!count)
+        return 0;
+    *(char *) buf = receive_byte();
+    return 1;
 }
 
 static ssize_t stdout_write(void * opaque, const void * buf, size_t count) {
-    int i;
-    const char * data = (const char *) buf;
-    
-    for (i = 0; i < count; i++)
-        send_byte(data[i]);
-    
+    send_bytes((const char *) buf, count);
     return count;
 }
 
 static xSemaphoreHandle fio_sem = NULL;
+static xStaticSemaphoreType fio_sem_buffer;
 
 __attribute__((constructor)) void fio_init() {
     memset(fio_fds, 0, sizeof(fio_fds));
     fio_fds[0].fdread = stdin_read;
     fio_fds[1].fdwrite = stdout_write;
     fio_fds[2].fdwrite = stdout_write;
-    fio_sem = xSemaphoreCreateMutex();
+    fio_sem = xSemaphoreCreateMutexStatic(&fio_sem_buffer);
+    fio_stream_init();
 }
 
 struct fddef_t * fio_getfd(int fd) {
@@ -47,6 +52,7 @@ static int fio_is_open_int(int fd) {
               (fio_fds[fd].fdwrite == NULL) &&
               (fio_fds[fd].fdseek == NULL) &&
               (fio_fds[fd].fdclose == NULL) &&
+              (fio_fds[fd].fdmmap == NULL) &&
               (fio_fds[fd].opaque == NULL));
     return r;
 }
@@ -153,6 +159,85 @@ void fio_set_opaque(int fd, void * opaque) {
         fio_fds[fd].opaque = opaque;
 }
 
+void fio_set_mmap(int fd, fdmmap_t fdmmap) {
+    if (fio_is_open_int(fd))
+        fio_fds[fd].fdmmap = fdmmap;
+}
+
+int fio_is_mappable(int fd) {
+    return fio_is_open_int(fd) && fio_fds[fd].fdmmap;
+}
+
+/* Points *ptr at the file contents, no copy is made.  The memory is only
+ * valid while the file stays open and must not be written. */
+int fio_mmap(int fd, const void ** ptr, size_t * len) {
+    int r = 0;
+    if (fio_is_open_int(fd)) {
+        if (fio_fds[fd].fdmmap) {
+            r = fio_fds[fd].fdmmap(fio_fds[fd].opaque, ptr, len);
+        } else {
+            r = -3;
+        }
+    } else {
+        r = -2;
+    }
+    return r;
+}
+
+/* Writes all of count, returning the first error. */
+static ssize_t fio_write_all(int fd, const char * buf, size_t count) {
+    ssize_t r;
+
+    while (count) {
+        r = fio_write(fd, buf, count);
+        if (r <= 0)
+            return r < 0 ? r : -1;
+        buf += r;
+        count -= r;
+    }
+
+    return 0;
+}
+
+#define FIO_COPY_CHUNK 64
+
+/* Copies fd_in from its current position to the end into fd_out, returning
+ * the number of bytes copied or the first error.  A mappable file is written
+ * in one go from where it lies; anything else goes through a small chunk
+ * buffer.  Writes to the serial port return once the data is queued for
+ * the DMA, so the next chunk is read while the last one is being sent. */
+ssize_t fio_copy(int fd_in, int fd_out) {
+    char buf[FIO_COPY_CHUNK];
+    const void * data;
+    size_t len;
+    ssize_t r, total = 0;
+    off_t pos;
+
+    if (fio_mmap(fd_in, &data, &len) == 0) {
+        /* Without a seek callback the file is always read from the start. */
+        pos = fio_seek(fd_in, 0, SEEK_CUR);
+        if (pos < 0)
+            pos = 0;
+        if ((size_t) pos < len) {
+            r = fio_write_all(fd_out, (const char *) data + pos, len - pos);
+            if (r < 0)
+                return r;
+            fio_seek(fd_in, 0, SEEK_END);
+            total = len - pos;
+        }
+        return total;
+    }
+
+    while ((r = fio_read(fd_in, buf, sizeof(buf))) > 0) {
+        ssize_t w = fio_write_all(fd_out, buf, r);
+        if (w < 0)
+            return w;
+        total += r;
+    }
+
+    return r < 0 ? r : total;
+}
+
 #define stdin_hash 0x0BA00421
 #define stdout_hash 0x7FA08308
 #define stderr_hash 0x7FA058A3
@@ -185,112 +270,35 @@ void register_devfs() {
     register_fs("dev", devfs_open, NULL);
 }
 
-int sprintf ( char * str, const char * format, ... )//only support %s (string), %c (charater) and %i(%d) (integer)
-{
-    va_list para;
-    va_start(para,format);
-    int curr_pos=0;
-    char ch[]={'0','\0'};
-    char integer[11];
-    str[0]='\0';
-    while(format[curr_pos]!='\0')
-    {
-        if(format[curr_pos]!='%')
-        {
-            ch[0]=format[curr_pos];
-            strcat(str,ch);
-        }
-        else
-        {
-            switch(format[++curr_pos])
-            {
-                case 's':
-                    strcat(str,va_arg(para,char*));
-                    break;
-                case 'c':
-                    ch[0]=(char)va_arg(para,int);
-                    strcat(str,ch);
-                    break;
-                case 'i':
-                case 'd':
-                    strcat(str,itoa(va_arg(para,int),integer));
-                    break;
-                case 'u':
-                    strcat(str,itoa(va_arg(para,unsigned),integer));
-                    break;
-                default:
-                    break;
-            }
-        }
-        curr_pos++;
-    }
-    va_end(para);
-    return strlen(str);
-}
+/* sprintf and friends are in format.c. */
+int printf(const char * format, ...) {
+    va_list ap;
+    int r;
 
-int printf ( const char * format, ... )
-{
-    char str[128];
-    va_list para;
-    va_start(para,format);
-    int curr_pos=0;
-    char ch[]={'0','\0'};
-    char integer[11];
-    str[0]='\0';
-    while(format[curr_pos]!='\0')
-    {
-        if(format[curr_pos]!='%')
-        {
-            ch[0]=format[curr_pos];
-            strcat(str,ch);
-        }
-        else
-        {
-            switch(format[++curr_pos])
-            {
-                case 's':
-                    strcat(str,va_arg(para,char*));
-                    break;
-                case 'c':
-                    ch[0]=(char)va_arg(para,int);
-                    strcat(str,ch);
-                    break;
-                case 'i':
-                case 'd':
-                    strcat(str,itoa(va_arg(para,int),integer));
-                    break;
-                case 'u':
-                    strcat(str,itoa(va_arg(para,unsigned),integer));
-                    break;
-                default:
-                    break;
-            }
-        }
-        curr_pos++;
-    }
-    va_end(para);
-    return fio_write(1,str,strlen(str));
+    va_start(ap, format);
+    r = fio_vfprintf(fio_stdout, format, ap);
+    va_end(ap);
+    return r;
 }
 
 
 void Puts(char *msg)
 {
 	if(!msg)return;
-	fio_write(1,msg,strlen(msg));
+	fio_fputs(msg, fio_stdout);
 }
 
+/* The line and its end reach the driver in one write. */
 void Print(char *msg)
 {
 	if(!msg)return;
-	char newLine[]="\n\r";
-	fio_write(1,msg,strlen(msg));
-	fio_write(1,newLine,strlen(newLine));
+	fio_fputs(msg, fio_stdout);
+	fio_fputs("\n\r", fio_stdout);
 }
 
 void Print_nextLine()
 {
-	char newLine[]="\n\r";
-	fio_write(1,newLine,strlen(newLine));
+	fio_fputs("\n\r", fio_stdout);
 }
 
 
@@ -316,12 +324,7 @@ static unsigned int lfsr = 0xACE1;
 // Get a pseudorandom number generator from Wikipedia
 static int prng(void)
 {
-    /*static unsigned int bit;
-    // taps: 16 14 13 11; characteristic polynomial: x^16 + x^14 + x^13 + x^11 + 1
-    bit  = ((lfsr >> 0) ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5) ) & 1;
-    lfsr =  (lfsr >> 1) | (bit << 15);*/
-
-
+#if defined(__arm__)
     __asm__ (
              "mov r0, %1             \n" // r0=lfsr
              "eor r1, r0, r0, lsr #2 \n" // r1 = (lfsr >> 0) ^ (lfsr >> 2)
@@ -335,10 +338,62 @@ static int prng(void)
              :"r"(lfsr)
              :"r0","r1"
     );
+#else
+    static unsigned int bit;
+    // taps: 16 14 13 11; characteristic polynomial: x^16 + x^14 + x^13 + x^11 + 1
+    bit  = ((lfsr >> 0) ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5) ) & 1;
+    lfsr =  (lfsr >> 1) | (bit << 15);
+#endif
     return lfsr & 0xffff;
 
 }
 
+/* Latency of every pvPortMalloc()/vPortFree() call, and the allocations that
+ * failed although enough bytes were free in total, i.e. to fragmentation. */
+static struct bench_stat mmtest_malloc_stat, mmtest_free_stat;
+static unsigned int mmtest_failed, mmtest_fragmented;
+static size_t mmtest_min_free;
+
+static void *mmtest_malloc(size_t size)
+{
+    size_t free_bytes = xPortGetFreeHeapSize();
+    unsigned long t0;
+    void *p;
+
+    t0 = bench_counter();
+    p = pvPortMalloc(size);
+    bench_stat_add(&mmtest_malloc_stat, bench_counter() - t0);
+
+    if (!p) {
+        mmtest_failed++;
+        if (free_bytes >= size)
+            mmtest_fragmented++;
+    }
+    if (xPortGetFreeHeapSize() < mmtest_min_free)
+        mmtest_min_free = xPortGetFreeHeapSize();
+    return p;
+}
+
+static void mmtest_free(void *p)
+{
+    unsigned long t0;
+
+    t0 = bench_counter();
+    vPortFree(p);
+    bench_stat_add(&mmtest_free_stat, bench_counter() - t0);
+}
+
+static void mmtest_report(void)
+{
+    printf("Latency in %s\r\n", bench_counter_unit());
+    bench_stat_print("pvPortMalloc", &mmtest_malloc_stat);
+    bench_stat_print("vPortFree", &mmtest_free_stat);
+    printf("%d allocations failed, %d of them with enough free bytes\r\n",
+           mmtest_failed, mmtest_fragmented);
+    printf("Lowest free heap %d bytes of %d\r\n",
+           (int) mmtest_min_free, (int) configTOTAL_HEAP_SIZE);
+}
+
 void mmtest_fio_function(char *str)
 {
     int i,j, size;
@@ -346,6 +401,12 @@ void mmtest_fio_function(char *str)
     unsigned int write_pointer = 0;
     unsigned int read_pointer = 0;
 
+    bench_counter_init();
+    bench_stat_reset(&mmtest_malloc_stat);
+    bench_stat_reset(&mmtest_free_stat);
+    mmtest_failed = mmtest_fragmented = 0;
+    mmtest_min_free = xPortGetFreeHeapSize();
+
     for(j=0; j<MMTEST_NUM; j++)
     {
         do{
@@ -353,7 +414,7 @@ void mmtest_fio_function(char *str)
         }while(size<MIN_ALLOC_SIZE);
 
         printf("try to allocate %d bytes\r\n", size);
-        p = (char *) pvPortMalloc(size);
+        p = (char *) mmtest_malloc(size);
         printf("malloc returned %d\r\n", p);
 
         if (p == NULL || (write_pointer+1)%CIRCBUFSIZE == read_pointer) {
@@ -374,7 +435,7 @@ void mmtest_fio_function(char *str)
                         return;
                     }
                 }
-                vPortFree(p);
+                mmtest_free(p);
                 if ((prng() & 1) == 0) break;
             }
             send_byte('\r');
@@ -382,7 +443,7 @@ void mmtest_fio_function(char *str)
         } else {
             printf("allocate a block, size %d\r\n\r\n", size);
             if (circbuf_size(write_pointer, read_pointer) == CIRCBUFSIZE - 1) {
-                fio_write(1,"circular buffer overflow\r\n",24);
+                fio_fputs("circular buffer overflow\r\n", fio_stdout);
                 return;
             }
             slots[write_pointer].pointer=p;
@@ -410,11 +471,37 @@ void mmtest_fio_function(char *str)
                 return;
             }
         }
-        vPortFree(p);
+        mmtest_free(p);
     }while(read_pointer!=write_pointer);
+
+    mmtest_report();
 }
 
 
+/* Reads a line from fd into buf, dropping the '\r' of "\n\r" line ends.
+ * Returns its length, or -1 at the end of the file. */
+int fio_getline(int fd, char * buf, int size)
+{
+	int len = 0;
+	char ch = 0;
+
+	while (fio_read(fd, &ch, 1) == 1) {
+		if (ch == '\n')
+			break;
+		if (ch != '\r' && len < size - 1)
+			buf[len++] = ch;
+	}
+	buf[len] = '\0';
+	return len || ch == '\n' ? len : -1;
+}
+
+/* Whatever is buffered for the terminal goes out before waiting on it. */
+static char read_byte(void)
+{
+	fio_fflush(fio_stdout);
+	return receive_byte();
+}
+
 void Read_Input(char *str,int MAX_SERIAL_STR)
 {
 	char ch;
@@ -423,9 +510,16 @@ void Read_Input(char *str,int MAX_SERIAL_STR)
 	curr_char = 0;
 	done = 0;
 	str[curr_char] = '\0';
+
+	/* Piped or redirected: plain lines, nothing to echo. */
+	if (fio_stdin() != 0) {
+		fio_getline(fio_stdin(), str, MAX_SERIAL_STR);
+		return;
+	}
+
 	do{
 		/* Receive a byte from the RS232 port (this call will block). */
-         	ch=receive_byte();
+         	ch=read_byte();
 
 		if (curr_char >= MAX_SERIAL_STR-1 || (ch == '\r') || (ch == '\n')){
 			str[curr_char] = '\0';
@@ -435,28 +529,27 @@ void Read_Input(char *str,int MAX_SERIAL_STR)
 		else if(ch == 127){ //press the backspace key
                 	if(curr_char!=0){
                     		curr_char--;
-                    		fio_write(1,"\b \b", 3);
+                    		fio_fputs("\b \b", fio_stdout);
               		}
             	}
             	else if(ch == 27){  //press up, down, left, right, home, page up, delete, end, page down
-                	ch=receive_byte();
+                	ch=read_byte();
                 	if(ch != '['){
                     		str[curr_char++] = ch;
-                    		fio_write(1, &ch, 1);
+                    		fio_fputc(ch, fio_stdout);
                 	}
                 	else{
-                    		ch=receive_byte();
+                    		ch=read_byte();
                    		 if(ch >= '1' && ch <= '6'){
-                        		ch=receive_byte();
+                        		ch=read_byte();
                     		}
                 	}
             	}
 		else{
 			str[curr_char++] = ch;
-			fio_write(1, &ch, 1);
+			fio_fputc(ch, fio_stdout);
 		}
 	} while (!done);
 
         Print_nextLine();
-	return str;
 }
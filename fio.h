@@ -18,12 +18,16 @@ typedef ssize_t (*fdread_t)(void * opaque, void * buf, size_t count);
 typedef ssize_t (*fdwrite_t)(void * opaque, const void * buf, size_t count);
 typedef off_t (*fdseek_t)(void * opaque, off_t offset, int whence);
 typedef int (*fdclose_t)(void * opaque);
+/* Hands back the whole contents of a file that sits in addressable memory,
+ * for reading in place. */
+typedef int (*fdmmap_t)(void * opaque, const void ** ptr, size_t * len);
 
 struct fddef_t {
     fdread_t fdread;
     fdwrite_t fdwrite;
     fdseek_t fdseek;
     fdclose_t fdclose;
+    fdmmap_t fdmmap;    /* NULL unless the file is directly addressable */
     void * opaque;
 };
 
@@ -34,10 +38,26 @@ __attribute__((constructor)) void fio_init();
 int fio_is_open(int fd);
 int fio_open(fdread_t, fdwrite_t, fdseek_t, fdclose_t, void * opaque);
 ssize_t fio_read(int fd, void * buf, size_t count);
+int fio_getline(int fd, char * buf, int size);
 ssize_t fio_write(int fd, const void * buf, size_t count);
 off_t fio_seek(int fd, off_t offset, int whence);
 int fio_close(int fd);
 void fio_set_opaque(int fd, void * opaque);
+void fio_set_mmap(int fd, fdmmap_t fdmmap);
+int fio_is_mappable(int fd);
+int fio_mmap(int fd, const void ** ptr, size_t * len);
+ssize_t fio_copy(int fd_in, int fd_out);
+
+/* Terminal helpers over fio_stdout.  Print and Print_nextLine end the line
+ * with "\n\r".  Read_Input takes a line from the terminal, with echo and
+ * editing, or from fio_stdin when that is redirected. */
+void Puts(char * msg);
+void Print(char * msg);
+void Print_nextLine();
+void Read_Input(char * str, int MAX_SERIAL_STR);
+
+/* The mmtest shell command. */
+void mmtest_fio_function(char * str);
 
 void register_devfs();
 
@@ -0,0 +1,267 @@
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include "format.h"
+
+#define FORMAT_LEFT  0x01       /* '-' */
+#define FORMAT_ZERO  0x02       /* '0' */
+#define FORMAT_PLUS  0x04       /* '+' */
+#define FORMAT_SPACE 0x08       /* ' ' */
+#define FORMAT_ALT   0x10       /* '#' */
+
+struct format_out {
+    format_sink_t sink;
+    void * opaque;
+    int count;
+};
+
+static void format_emit(struct format_out * out, const char * s, size_t n) {
+    if (n) {
+        out->sink(out->opaque, s, n);
+        out->count += n;
+    }
+}
+
+static void format_pad(struct format_out * out, char c, int n) {
+    static const char spaces[] = "                ";
+    static const char zeros[] = "0000000000000000";
+    const char * run = c == '0' ? zeros : spaces;
+
+    while (n > 0) {
+        format_emit(out, run, n > 16 ? 16 : n);
+        n -= 16;
+    }
+}
+
+/* Lays out |pad|prefix|zeros|body|pad| to the field width. */
+static void format_field(struct format_out * out, int flags, int width,
+                         const char * prefix, int prefix_len,
+                         int zeros, const char * body, int len) {
+    int pad = width - prefix_len - zeros - len;
+
+    if (flags & FORMAT_ZERO) {
+        zeros += pad > 0 ? pad : 0;
+        pad = 0;
+    }
+    if (!(flags & FORMAT_LEFT))
+        format_pad(out, ' ', pad);
+    format_emit(out, prefix, prefix_len);
+    format_pad(out, '0', zeros);
+    format_emit(out, body, len);
+    if (flags & FORMAT_LEFT)
+        format_pad(out, ' ', pad);
+}
+
+static void format_number(struct format_out * out, unsigned long value, int negative,
+                          unsigned base, int upper, int flags, int width, int precision) {
+    const char * digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char buf[sizeof(unsigned long) * 3];    /* octal digits of the widest value */
+    char prefix[2];
+    char * p = buf + sizeof(buf);
+    int prefix_len = 0, len, zeros;
+
+    /* A precision of 0 prints nothing for 0. */
+    while (value || (p == buf + sizeof(buf) && precision != 0)) {
+        *--p = digits[value % base];
+        value /= base;
+    }
+    len = buf + sizeof(buf) - p;
+
+    if (negative)
+        prefix[prefix_len++] = '-';
+    else if (flags & FORMAT_PLUS)
+        prefix[prefix_len++] = '+';
+    else if (flags & FORMAT_SPACE)
+        prefix[prefix_len++] = ' ';
+
+    if ((flags & FORMAT_ALT) && base == 16 && len && !(len == 1 && *p == '0')) {
+        prefix[prefix_len++] = '0';
+        prefix[prefix_len++] = upper ? 'X' : 'x';
+    }
+
+    zeros = precision > len ? precision - len : 0;
+    if ((flags & FORMAT_ALT) && base == 8 && !zeros && (!len || *p != '0'))
+        zeros = 1;
+
+    /* An explicit precision overrides the 0 flag. */
+    if (precision >= 0)
+        flags &= ~FORMAT_ZERO;
+
+    format_field(out, flags, width, prefix, prefix_len, zeros, p, len);
+}
+
+int format_vprint(format_sink_t sink, void * opaque, const char * fmt, va_list ap) {
+    struct format_out out = { sink, opaque, 0 };
+    const char * run, * s;
+    unsigned long u;
+    long d;
+    int flags, width, precision, length, len;
+    char c;
+
+    while (*fmt) {
+        /* Copy up to the next conversion in one go. */
+        for (run = fmt; *fmt && *fmt != '%'; fmt++);
+        format_emit(&out, run, fmt - run);
+        if (!*fmt)
+            break;
+        run = fmt++;
+
+        flags = 0;
+        for (;; fmt++) {
+            if (*fmt == '-')
+                flags |= FORMAT_LEFT;
+            else if (*fmt == '0')
+                flags |= FORMAT_ZERO;
+            else if (*fmt == '+')
+                flags |= FORMAT_PLUS;
+            else if (*fmt == ' ')
+                flags |= FORMAT_SPACE;
+            else if (*fmt == '#')
+                flags |= FORMAT_ALT;
+            else
+                break;
+        }
+
+        width = 0;
+        if (*fmt == '*') {
+            width = va_arg(ap, int);
+            if (width < 0) {
+                flags |= FORMAT_LEFT;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9')
+                width = width * 10 + *fmt++ - '0';
+        }
+        if (flags & FORMAT_LEFT)
+            flags &= ~FORMAT_ZERO;
+
+        precision = -1;
+        if (*fmt == '.') {
+            fmt++;
+            precision = 0;
+            if (*fmt == '*') {
+                precision = va_arg(ap, int);
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9')
+                    precision = precision * 10 + *fmt++ - '0';
+            }
+        }
+
+        /* 'h' and "hh" arguments arrive promoted to int anyway. */
+        length = 0;
+        while (*fmt == 'h')
+            fmt++;
+        if (*fmt == 'l' || *fmt == 'z') {
+            length = 1;
+            fmt++;
+        }
+
+        switch (c = *fmt++) {
+        case 'd':
+        case 'i':
+            if (length)
+                d = va_arg(ap, long);
+            else
+                d = va_arg(ap, int);
+            u = d < 0 ? 0UL - (unsigned long) d : (unsigned long) d;
+            format_number(&out, u, d < 0, 10, 0, flags, width, precision);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            if (length)
+                u = va_arg(ap, unsigned long);
+            else
+                u = va_arg(ap, unsigned int);
+            flags &= ~(FORMAT_PLUS | FORMAT_SPACE);
+            format_number(&out, u, 0, c == 'u' ? 10 : c == 'o' ? 8 : 16, c == 'X',
+                          flags, width, precision);
+            break;
+        case 'p':
+            u = (unsigned long) (uintptr_t) va_arg(ap, void *);
+            format_number(&out, u, 0, 16, 0, (flags | FORMAT_ALT) & ~(FORMAT_PLUS | FORMAT_SPACE),
+                          width, precision);
+            break;
+        case 's':
+            s = va_arg(ap, const char *);
+            if (!s)
+                s = "(null)";
+            /* Never look past the precision, the string need not end. */
+            for (len = 0; (precision < 0 || len < precision) && s[len]; len++);
+            format_field(&out, flags & ~FORMAT_ZERO, width, NULL, 0, 0, s, len);
+            break;
+        case 'c':
+            c = (char) va_arg(ap, int);
+            format_field(&out, flags & ~FORMAT_ZERO, width, NULL, 0, 0, &c, 1);
+            break;
+        case '%':
+            format_emit(&out, "%", 1);
+            break;
+        default:
+            /* Unknown conversion, print it as it was written. */
+            if (!c)
+                fmt--;
+            format_emit(&out, run, fmt - run);
+            break;
+        }
+    }
+
+    return out.count;
+}
+
+/* String output ----------------------------------------------------------*/
+
+struct format_buf {
+    char * buf;
+    size_t size;
+    size_t len;
+};
+
+/* Keeps what fits, leaving room for the terminating zero. */
+static void format_buf_sink(void * opaque, const char * s, size_t n) {
+    struct format_buf * b = (struct format_buf *) opaque;
+    size_t room = b->size ? b->size - 1 - b->len : 0;
+
+    if (n > room)
+        n = room;
+    while (n--)
+        b->buf[b->len++] = *s++;
+}
+
+int vsnprintf(char * str, size_t size, const char * fmt, va_list ap) {
+    struct format_buf b = { str, size, 0 };
+    int r = format_vprint(format_buf_sink, &b, fmt, ap);
+
+    if (size)
+        str[b.len] = '\0';
+    return r;
+}
+
+int snprintf(char * str, size_t size, const char * fmt, ...) {
+    va_list ap;
+    int r;
+
+    va_start(ap, fmt);
+    r = vsnprintf(str, size, fmt, ap);
+    va_end(ap);
+    return r;
+}
+
+/* Unbounded, as the C library's; prefer snprintf. */
+int vsprintf(char * str, const char * fmt, va_list ap) {
+    return vsnprintf(str, SIZE_MAX / 2, fmt, ap);
+}
+
+int sprintf(char * str, const char * fmt, ...) {
+    va_list ap;
+    int r;
+
+    va_start(ap, fmt);
+    r = vsprintf(str, fmt, ap);
+    va_end(ap);
+    return r;
+}
@@ -0,0 +1,28 @@
+#ifndef __FORMAT_H__
+#define __FORMAT_H__
+
+#include <stddef.h>
+#include <stdarg.h>
+
+/* printf style formatting into a callback, the one engine behind printf,
+ * sprintf and friends.  Output is handed to the sink in runs as it is
+ * produced, so nothing is buffered or allocated here and the time taken is
+ * linear in the output.
+ *
+ * Supported: %d %i %u %x %X %o %p %s %c %%, the flags - 0 + space #, a
+ * width and a precision (either may be *), and the h, hh, l and z length
+ * modifiers.  There is no floating point and no %ll, 64-bit division would
+ * need libgcc on the target. */
+typedef void (*format_sink_t)(void * opaque, const char * s, size_t n);
+
+/* Returns the number of characters produced. */
+int format_vprint(format_sink_t sink, void * opaque, const char * fmt, va_list ap);
+
+/* The C library's string versions, over format_vprint().  printf is in
+ * fio.c, on the buffered stdout. */
+int vsnprintf(char * str, size_t size, const char * fmt, va_list ap);
+int snprintf(char * str, size_t size, const char * fmt, ...);
+int vsprintf(char * str, const char * fmt, va_list ap);
+int sprintf(char * str, const char * fmt, ...);
+
+#endif
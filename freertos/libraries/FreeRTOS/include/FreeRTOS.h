@@ -472,6 +472,30 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )
 #endif
 
+#ifndef traceMALLOC
+	/* Called when a block has been allocated from the heap.  pvAddress is NULL
+	if the allocation failed, uiSize is the size of the block taken. */
+	#define traceMALLOC( pvAddress, uiSize )
+#endif
+
+#ifndef traceMALLOC_ON_BEHALF_OF
+	/* Called with the scheduler suspended just before a wrapper such as
+	pvMemPoolTakeOrMalloc() allocates for pvCaller, so the next traceMALLOC can
+	name pvCaller rather than the wrapper. */
+	#define traceMALLOC_ON_BEHALF_OF( pvCaller )
+#endif
+
+#ifndef traceFREE
+	/* Called when a block is returned to the heap, uiSize is its size. */
+	#define traceFREE( pvAddress, uiSize )
+#endif
+
+#ifndef traceISR_ENTER
+	/* Not called by the kernel.  Interrupt handlers of the application place
+	it at their start so a trace shows what ran outside of the tasks. */
+	#define traceISR_ENTER()
+#endif
+
 #ifndef configGENERATE_RUN_TIME_STATS
 	#define configGENERATE_RUN_TIME_STATS 0
 #endif
@@ -494,10 +518,66 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
 #endif
 
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE 0
+#endif
+
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+	#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+	#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )
+#endif
+
+#ifndef configPRE_SLEEP_PROCESSING
+	#define configPRE_SLEEP_PROCESSING( x )
+#endif
+
+#ifndef configPOST_SLEEP_PROCESSING
+	#define configPOST_SLEEP_PROCESSING( x )
+#endif
+
+#ifndef configUSE_TASK_NOTIFICATIONS
+	#define configUSE_TASK_NOTIFICATIONS 1
+#endif
+
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
 #ifndef configUSE_MALLOC_FAILED_HOOK
 	#define configUSE_MALLOC_FAILED_HOOK 0
 #endif
 
+/* Number of TCBs, task stacks, queue control blocks and timers to take from
+fixed size block pools (see mempool.h) rather than the heap.  Objects that do
+not fit or find their pool empty still come from the heap.  Stacks in the
+pool are configSTACK_POOL_DEPTH words deep. */
+#ifndef configTCB_POOL_SIZE
+	#define configTCB_POOL_SIZE 0
+#endif
+
+#ifndef configSTACK_POOL_SIZE
+	#define configSTACK_POOL_SIZE 0
+#endif
+
+#ifndef configSTACK_POOL_DEPTH
+	#define configSTACK_POOL_DEPTH configMINIMAL_STACK_SIZE
+#endif
+
+#ifndef configQUEUE_POOL_SIZE
+	#define configQUEUE_POOL_SIZE 0
+#endif
+
+#ifndef configTIMER_POOL_SIZE
+	#define configTIMER_POOL_SIZE 0
+#endif
+
 #ifndef portPRIVILEGE_BIT
 	#define portPRIVILEGE_BIT ( ( unsigned portBASE_TYPE ) 0x00 )
 #endif
@@ -514,5 +594,102 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define vPortFreeAligned( pvBlockToFree ) vPortFree( pvBlockToFree )
 #endif
 
+/* Set to 1 to build xTaskCreateStatic(), xQueueCreateStatic(),
+xSemaphoreCreateBinaryStatic(), xSemaphoreCreateMutexStatic() and
+xTimerCreateStatic(), which place the object in memory supplied by the caller
+instead of taking it from the heap or a block pool. */
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/*
+	 * Storage for statically allocated kernel objects.  These have the size
+	 * and alignment of the private structures in tasks.c, queue.c and
+	 * timers.c, which are otherwise hidden from the application - the members
+	 * are not meant to be accessed.  Each of those files refuses to build if
+	 * its structure and the one here drift apart.
+	 */
+	typedef struct xSTATIC_LIST_ITEM
+	{
+		portTickType xDummy1;
+		void *pvDummy2[ 4 ];
+	} xStaticListItem;
+
+	typedef struct xSTATIC_MINI_LIST_ITEM
+	{
+		portTickType xDummy1;
+		void *pvDummy2[ 2 ];
+	} xStaticMiniListItem;
+
+	typedef struct xSTATIC_LIST
+	{
+		unsigned portBASE_TYPE uxDummy1;
+		void *pvDummy2;
+		xStaticMiniListItem xDummy3;
+	} xStaticList;
+
+	typedef struct xSTATIC_TCB
+	{
+		void *pxDummy1;
+		#if ( portUSING_MPU_WRAPPERS == 1 )
+			xMPU_SETTINGS xDummy2;
+		#endif
+		xStaticListItem xDummy3[ 2 ];
+		unsigned portBASE_TYPE uxDummy4;
+		void *pxDummy5;
+		signed char ucDummy6[ configMAX_TASK_NAME_LEN ];
+		#if ( portSTACK_GROWTH > 0 )
+			void *pxDummy7;
+		#endif
+		#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+			unsigned portBASE_TYPE uxDummy8;
+		#endif
+		#if ( configUSE_TRACE_FACILITY == 1 )
+			unsigned portBASE_TYPE uxDummy9[ 2 ];
+		#endif
+		#if ( configUSE_MUTEXES == 1 )
+			unsigned portBASE_TYPE uxDummy10;
+		#endif
+		#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+			void *pxDummy11;
+		#endif
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+			unsigned long ulDummy12[ 2 ];
+		#endif
+		#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+			unsigned long ulDummy13;
+			int iDummy14;
+		#endif
+		unsigned char ucDummy15;
+	} xStaticTaskType;
+
+	typedef struct xSTATIC_QUEUE
+	{
+		void *pvDummy1[ 4 ];
+		xStaticList xDummy2[ 2 ];
+		unsigned portBASE_TYPE uxDummy3[ 3 ];
+		signed portBASE_TYPE xDummy4[ 2 ];
+		#if ( configUSE_TRACE_FACILITY == 1 )
+			unsigned char ucDummy5[ 2 ];
+		#endif
+		unsigned char ucDummy6;
+	} xStaticQueueType;
+
+	typedef xStaticQueueType xStaticSemaphoreType;
+
+	typedef struct xSTATIC_TIMER
+	{
+		void *pvDummy1;
+		xStaticListItem xDummy2;
+		portTickType xDummy3;
+		unsigned portBASE_TYPE uxDummy4;
+		void *pvDummy5[ 2 ];
+		unsigned char ucDummy6;
+	} xStaticTimerType;
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
 #endif /* INC_FREERTOS_H */
 
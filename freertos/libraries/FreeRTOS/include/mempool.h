@@ -0,0 +1,186 @@
+/*
+    FreeRTOS V7.1.1 - Copyright (C) 2012 Real Time Engineers Ltd.
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    ***************************************************************************
+     *                                                                       *
+     *    Having a problem?  Start by reading the FAQ "My application does   *
+     *    not run, what could be wrong?                                      *
+     *                                                                       *
+     *    http://www.FreeRTOS.org/FAQHelp.html                               *
+     *                                                                       *
+    ***************************************************************************
+
+
+    http://www.FreeRTOS.org - Documentation, training, latest information,
+    license and contact details.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool.
+
+    Real Time Engineers ltd license FreeRTOS to High Integrity Systems, who sell
+    the code with commercial support, indemnification, and middleware, under
+    the OpenRTOS brand: http://www.OpenRTOS.com.  High Integrity Systems also
+    provide a safety engineered and independently SIL3 certified version under
+    the SafeRTOS brand: http://www.SafeRTOS.com.
+*/
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h" must appear in source files before "include mempool.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fixed size block pools.
+ *
+ * A pool hands out blocks of one size from a caller supplied array.  Taking
+ * and giving a block is a single compare and swap on the head of a free list,
+ * so both are O(1), need no critical section and may be used from tasks and
+ * interrupts alike.  There is no per block header, and as every block has the
+ * same size the pool cannot fragment.
+ *
+ * Pools need no initialisation call: blocks that were never taken are handed
+ * out in order from the array before the free list is used, so a pool can be
+ * defined statically with memPOOL_INITIALISER().
+ *
+ * Example:
+ *
+ *	static unsigned char ucStorage[ memPOOL_STORAGE_SIZE( 32, 10 ) ] memPOOL_ALIGNED;
+ *	static xMemPool xPool = memPOOL_INITIALISER( ucStorage, 32, 10 );
+ *
+ *	void *pv = pvMemPoolTake( &xPool );
+ *	...
+ *	vMemPoolGive( &xPool, pv );
+ */
+
+/* The free list head packs the index of the first free block in the low 16
+bits with a counter in the high 16 bits that changes on every update, so a
+compare and swap cannot succeed on a head that was taken and given back in
+the meantime. */
+#define memPOOL_NO_BLOCK		( 0xFFFFUL )
+
+typedef struct xMEM_POOL
+{
+	unsigned char *pucStorage;						/*< The blocks. */
+	size_t xBlockSize;								/*< Size of each block, a multiple of portBYTE_ALIGNMENT. */
+	unsigned portBASE_TYPE uxBlockCount;			/*< Number of blocks in pucStorage. */
+	volatile unsigned long ulFreeHead;				/*< Counter and index of the first block on the free list. */
+	volatile unsigned portBASE_TYPE uxUnused;		/*< Blocks from this index on have never been taken. */
+	volatile unsigned portBASE_TYPE uxBlocksTaken;	/*< Blocks currently in use. */
+} xMemPool;
+
+/* Block sizes are rounded up so every block stays aligned. */
+#define memPOOL_BLOCK_SIZE( xSize )		( ( ( xSize ) + portBYTE_ALIGNMENT - 1 ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define memPOOL_STORAGE_SIZE( xSize, uxCount )	( memPOOL_BLOCK_SIZE( xSize ) * ( uxCount ) )
+#define memPOOL_ALIGNED					__attribute__ ( ( aligned( portBYTE_ALIGNMENT ) ) )
+
+#define memPOOL_INITIALISER( pucStorage, xSize, uxCount )	\
+	{ ( unsigned char * ) ( pucStorage ), memPOOL_BLOCK_SIZE( xSize ), ( uxCount ), memPOOL_NO_BLOCK, 0, 0 }
+
+/**
+ * mempool.h
+ * <pre>void vMemPoolInit( xMemPool *pxPool, void *pvStorage, size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount );</pre>
+ *
+ * Set up a pool at run time, the same as memPOOL_INITIALISER() does
+ * statically.  pvStorage must be aligned to portBYTE_ALIGNMENT and hold
+ * memPOOL_STORAGE_SIZE( xBlockSize, uxBlockCount ) bytes.  A pool holds at
+ * most memPOOL_NO_BLOCK - 1 blocks.
+ */
+void vMemPoolInit( xMemPool *pxPool, void *pvStorage, size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ * <pre>void *pvMemPoolTake( xMemPool *pxPool );</pre>
+ *
+ * Take a block from the pool.  Can be called from an interrupt.
+ *
+ * @return The block, or NULL if all blocks are in use.
+ */
+void *pvMemPoolTake( xMemPool *pxPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ * <pre>void vMemPoolGive( xMemPool *pxPool, void *pv );</pre>
+ *
+ * Return a block obtained from pvMemPoolTake() to the pool.  Can be called
+ * from an interrupt.
+ */
+void vMemPoolGive( xMemPool *pxPool, void *pv ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ * <pre>portBASE_TYPE xMemPoolContains( const xMemPool *pxPool, const void *pv );</pre>
+ *
+ * @return pdTRUE if pv is a block of the pool.  Lets callers that fall back
+ * to the heap when a pool is exhausted know where to return a block.
+ */
+portBASE_TYPE xMemPoolContains( const xMemPool *pxPool, const void *pv ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ * <pre>void *pvMemPoolTakeOrMalloc( xMemPool *pxPool, size_t xSize );
+ * void vMemPoolGiveOrFree( xMemPool *pxPool, void *pv );</pre>
+ *
+ * Take a block if xSize fits the pool and one is free, otherwise fall back to
+ * pvPortMalloc().  vMemPoolGiveOrFree() returns pv to wherever it came from.
+ * This is how the kernel uses its object pools (configTCB_POOL_SIZE and
+ * friends), so an undersized pool costs heap space instead of failing.  Not
+ * for use from interrupts, as the heap is not.
+ */
+void *pvMemPoolTakeOrMalloc( xMemPool *pxPool, size_t xSize ) PRIVILEGED_FUNCTION;
+void vMemPoolGiveOrFree( xMemPool *pxPool, void *pv ) PRIVILEGED_FUNCTION;
+
+/* Number of blocks currently taken. */
+#define uxMemPoolBlocksTaken( pxPool )	( ( pxPool )->uxBlocksTaken )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEMPOOL_H */
+
@@ -370,6 +370,45 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Heap usage figures, for sizing configTOTAL_HEAP_SIZE.  Block sizes include
+ * the allocator's own header.  Free block n of the histogram is counted in
+ * bucket n when it is smaller than ( 32 << n ) bytes, the last bucket takes
+ * everything larger.  heap_3.c, which defers to the C library, counts its
+ * blocks against configTOTAL_HEAP_SIZE and reports no free blocks.
+ */
+#define portHEAP_HISTOGRAM_BUCKETS	8
+
+typedef struct xHEAP_STATS
+{
+	size_t xAvailableHeapSpaceInBytes;
+	size_t xSizeOfLargestFreeBlockInBytes;
+	size_t xSizeOfSmallestFreeBlockInBytes;
+	size_t xNumberOfFreeBlocks;
+	size_t xMinimumEverFreeBytesRemaining;
+	size_t xNumberOfSuccessfulAllocations;
+	size_t xNumberOfSuccessfulFrees;
+	size_t xFreeBlockHistogram[ portHEAP_HISTOGRAM_BUCKETS ];
+} xHeapStatsType;
+
+size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * Extra memory for heap_5.c to spread the heap over, such as external SRAM.
+ * The table ends with an entry whose pucStartAddress is NULL.  xFast marks
+ * memory as quick as the internal SRAM, which small allocations prefer.  Must
+ * be called before the first pvPortMalloc().
+ */
+typedef struct xHEAP_REGION
+{
+	unsigned char *pucStartAddress;
+	size_t xSizeInBytes;
+	portBASE_TYPE xFast;
+} xHeapRegionType;
+
+void vPortDefineHeapRegions( const xHeapRegionType * const pxHeapRegions ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -156,6 +156,49 @@ typedef void * xQueueHandle;
  */
 #define xQueueCreate( uxQueueLength, uxItemSize ) xQueueGenericCreate( uxQueueLength, uxItemSize, queueQUEUE_TYPE_BASE )
 
+/**
+ * queue. h
+ * <pre>
+ xQueueHandle xQueueCreateStatic(
+							  unsigned portBASE_TYPE uxQueueLength,
+							  unsigned portBASE_TYPE uxItemSize,
+							  unsigned char *pucQueueStorage,
+							  xStaticQueueType *pxQueueBuffer
+						  );
+ * </pre>
+ *
+ * As xQueueCreate(), but the queue structure and its storage area are
+ * supplied by the caller rather than taken from the heap.  Both must remain
+ * valid for the lifetime of the queue, vQueueDelete() does not free them.
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this macro to be available.
+ *
+ * @param pucQueueStorage An array of at least uxQueueLength * uxItemSize
+ * bytes, or NULL if uxItemSize is zero.
+ *
+ * @param pxQueueBuffer Holds the queue structure.
+ *
+ * @return The handle of the queue, or NULL if pxQueueBuffer is NULL.
+ *
+ * Example usage:
+   <pre>
+ #define QUEUE_LENGTH 10
+
+ static unsigned char ucQueueStorage[ QUEUE_LENGTH * sizeof( unsigned long ) ];
+ static xStaticQueueType xQueueBuffer;
+
+ void vATask( void *pvParameters )
+ {
+ xQueueHandle xQueue;
+
+	xQueue = xQueueCreateStatic( QUEUE_LENGTH, sizeof( unsigned long ), ucQueueStorage, &xQueueBuffer );
+ }
+ </pre>
+ * \defgroup xQueueCreateStatic xQueueCreateStatic
+ * \ingroup QueueManagement
+ */
+#define xQueueCreateStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxQueueLength ), ( uxItemSize ), ( pucQueueStorage ), ( pxQueueBuffer ), queueQUEUE_TYPE_BASE )
+
 /**
  * queue. h
  * <pre>
@@ -1287,6 +1330,16 @@ portBASE_TYPE xQueueGiveMutexRecursive( xQueueHandle pxMutex );
  */
 xQueueHandle xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType );
 
+/*
+ * The same for queues, semaphores and mutexes in memory supplied by the
+ * caller.  Use xQueueCreateStatic(), xSemaphoreCreateBinaryStatic() or
+ * xSemaphoreCreateMutexStatic() rather than calling these directly.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue, unsigned char ucQueueType );
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueueType *pxStaticQueue );
+#endif
+
 /* Not public API functions. */
 void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait );
 portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue );
@@ -127,6 +127,36 @@ typedef xQueueHandle xSemaphoreHandle;
 		}																																		\
 	}
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateBinaryStatic( xStaticSemaphoreType *pxSemaphoreBuffer )</pre>
+ *
+ * <i>Macro</i> that creates a binary semaphore in memory supplied by the
+ * caller, so no heap is used.  Unlike vSemaphoreCreateBinary() the semaphore
+ * starts out empty - it must be given before it can be taken.
+ * pxSemaphoreBuffer must remain valid for the lifetime of the semaphore,
+ * vQueueDelete() does not free it.  configSUPPORT_STATIC_ALLOCATION must be
+ * set to 1 in FreeRTOSConfig.h for this macro to be available.
+ *
+ * @return Handle to the created semaphore, or NULL if pxSemaphoreBuffer is
+ * NULL.
+ *
+ * Example usage:
+ <pre>
+ static xStaticSemaphoreType xSemaphoreBuffer;
+
+ void vATask( void * pvParameters )
+ {
+ xSemaphoreHandle xSemaphore;
+
+    xSemaphore = xSemaphoreCreateBinaryStatic( &xSemaphoreBuffer );
+ }
+ </pre>
+ * \defgroup xSemaphoreCreateBinaryStatic xSemaphoreCreateBinaryStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateBinaryStatic( pxSemaphoreBuffer ) xQueueGenericCreateStatic( ( unsigned portBASE_TYPE ) 1, semSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, ( pxSemaphoreBuffer ), queueQUEUE_TYPE_BINARY_SEMAPHORE )
+
 /**
  * semphr. h
  * <pre>xSemaphoreTake(
@@ -601,6 +631,22 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateMutex() xQueueCreateMutex( queueQUEUE_TYPE_MUTEX )
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateMutexStatic( xStaticSemaphoreType *pxMutexBuffer )</pre>
+ *
+ * <i>Macro</i> that creates a mutex, as xSemaphoreCreateMutex(), in memory
+ * supplied by the caller.  pxMutexBuffer must remain valid for the lifetime
+ * of the mutex.  configSUPPORT_STATIC_ALLOCATION must be set to 1 in
+ * FreeRTOSConfig.h for this macro to be available.
+ *
+ * @return Handle to the created mutex, or NULL if pxMutexBuffer is NULL.
+ *
+ * \defgroup xSemaphoreCreateMutexStatic xSemaphoreCreateMutexStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateMutexStatic( pxMutexBuffer ) xQueueCreateMutexStatic( queueQUEUE_TYPE_MUTEX, ( pxMutexBuffer ) )
+
 
 /**
  * semphr. h
@@ -98,6 +98,56 @@ extern "C" {
  */
 typedef void * xTaskHandle;
 
+/*
+ * Task states returned by uxTaskGetSystemState().
+ */
+typedef enum
+{
+	eRunning = 0,	/* A task is querying the state of itself, so must be running. */
+	eReady,			/* The task being queried is in a read or pending ready list. */
+	eBlocked,		/* The task being queried is in the Blocked state. */
+	eSuspended,		/* The task being queried is in the Suspended state, or is in the Blocked state with an infinite time out. */
+	eDeleted		/* The task being queried has been deleted, but its TCB has not yet been freed. */
+} eTaskState;
+
+/*
+ * Used with the uxTaskGetSystemState() function to return the state of each
+ * task in the system.
+ */
+typedef struct xTASK_STATUS
+{
+	xTaskHandle xHandle;						/* The handle of the task to which the rest of the information in the structure relates. */
+	const signed char *pcTaskName;				/* A pointer to the task's name. */
+	unsigned portBASE_TYPE xTaskNumber;			/* A number unique to the task. */
+	eTaskState eCurrentState;					/* The state in which the task existed when the structure was populated. */
+	unsigned portBASE_TYPE uxCurrentPriority;	/* The priority at which the task was running (may be inherited) when the structure was populated. */
+	unsigned portBASE_TYPE uxBasePriority;		/* The priority to which the task will return if the task's current priority has been inherited to avoid unbounded priority inversion when obtaining a mutex. */
+	unsigned long ulRunTimeCounter;				/* The total run time allocated to the task so far, in run time stats counter ticks.  Zero unless configGENERATE_RUN_TIME_STATS is 1. */
+	unsigned long ulSwitchCount;				/* The number of times the task has been switched in.  Zero unless configGENERATE_RUN_TIME_STATS is 1. */
+	unsigned short usStackHighWaterMark;		/* The minimum amount of stack space that has remained for the task since the task was created, in words. */
+} xTaskStatusType;
+
+/*
+ * Possible return values for eTaskConfirmSleepModeStatus().
+ */
+typedef enum
+{
+	eAbortSleep = 0,		/* A task has been made ready or a context switch pended since portSUPPRESS_TICKS_AND_SLEEP() was called - abort entering a sleep mode. */
+	eStandardSleep			/* Enter a sleep mode that will not last any longer than the expected idle time. */
+} eSleepModeStatus;
+
+/*
+ * Actions that can be performed when xTaskNotify() is called.
+ */
+typedef enum
+{
+	eNoAction = 0,				/* Notify the task without updating its notify value. */
+	eSetBits,					/* Set bits in the task's notification value. */
+	eIncrement,					/* Increment the task's notification value. */
+	eSetValueWithOverwrite,		/* Set the task's notification value to a specific value even if the previous value has not yet been read by the task. */
+	eSetValueWithoutOverwrite	/* Set the task's notification value if the previous value has been read by the task. */
+} eNotifyAction;
+
 /*
  * Used internally only.
  */
@@ -283,6 +333,54 @@ typedef struct xTASK_PARAMTERS
  */
 #define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
 
+/**
+ * task. h
+ *<pre>
+ xTaskHandle xTaskCreateStatic(
+							  pdTASK_CODE pvTaskCode,
+							  const char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  portSTACK_TYPE *puxStackBuffer,
+							  xStaticTaskType *pxTaskBuffer
+						  );</pre>
+ *
+ * As xTaskCreate(), but the stack and the TCB live in memory supplied by the
+ * caller, so creating the task never touches the heap and the memory shows up
+ * in the map file.  configSUPPORT_STATIC_ALLOCATION must be set to 1 in
+ * FreeRTOSConfig.h for this function to be available.
+ *
+ * @param puxStackBuffer An array of at least usStackDepth portSTACK_TYPE
+ * variables, used as the task's stack.
+ *
+ * @param pxTaskBuffer Holds the TCB.
+ *
+ * Both must remain valid for the lifetime of the task.  vTaskDelete() does
+ * not free them; they can be reused once the idle task has cleaned the task
+ * up.
+ *
+ * @return The handle of the created task, or NULL if either buffer is NULL.
+ *
+ * Example usage:
+   <pre>
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+ static xStaticTaskType xTaskBuffer;
+
+ void vOtherFunction( void )
+ {
+ xTaskHandle xHandle;
+
+	 xHandle = xTaskCreateStatic( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, xStack, &xTaskBuffer );
+ }
+   </pre>
+ * \defgroup xTaskCreateStatic xTaskCreateStatic
+ * \ingroup Tasks
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskHandle xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  *<pre>
@@ -1119,6 +1217,33 @@ void vTaskStartTrace( signed char * pcBuffer, unsigned long ulBufferSize ) PRIVI
  */
 unsigned long ulTaskEndTrace( void ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime );</PRE>
+ *
+ * configUSE_TRACE_FACILITY must be defined as 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * Populates an xTaskStatusType structure for each task in the system, which
+ * unlike vTaskList() leaves the formatting to the caller.  The scheduler is
+ * suspended while the lists are walked, so this is intended for debugging.
+ *
+ * @param pxTaskStatusArray An array of uxArraySize structures.
+ *
+ * @param uxArraySize The size of pxTaskStatusArray.  If it is smaller than
+ * uxTaskGetNumberOfTasks() nothing is written and 0 is returned.
+ *
+ * @param pulTotalRunTime If configGENERATE_RUN_TIME_STATS is 1 and
+ * pulTotalRunTime is not NULL, set to the current run time stats counter
+ * value.
+ *
+ * @return The number of structures that were populated.
+ *
+ * \page uxTaskGetSystemState uxTaskGetSystemState
+ * \ingroup TaskUtils
+ */
+unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime ) PRIVILEGED_FUNCTION;
+
 /**
  * task.h
  * <PRE>unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask );</PRE>
@@ -1188,6 +1313,120 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 xTaskHandle xTaskGetIdleTaskHandle( void );
 
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction );</PRE>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be undefined or defined as 1 for this
+ * function to be available.
+ *
+ * Each task has a 32-bit notification value, which is initialised to zero
+ * when the task is created.  Sending a notification to a task unblocks it if
+ * it is waiting in xTaskNotifyWait() or ulTaskNotifyTake(), without the need
+ * for an intermediary queue, semaphore or event group object.  The
+ * notification value can optionally be updated as well:
+ *
+ * eSetBits - ulValue is ORed into the notification value, like a light
+ * weight event group.
+ *
+ * eIncrement - the notification value is incremented, like a light weight
+ * counting or binary semaphore.  ulValue is not used.  See xTaskNotifyGive().
+ *
+ * eSetValueWithOverwrite - the notification value is set to ulValue, like a
+ * light weight length one queue that is overwritten.
+ *
+ * eSetValueWithoutOverwrite - the notification value is set to ulValue only if
+ * the task has no notification pending, otherwise pdFAIL is returned.
+ *
+ * eNoAction - the task is notified without its notification value changing.
+ *
+ * @return pdFAIL if eAction is eSetValueWithoutOverwrite and the value could
+ * not be written, otherwise pdPASS.
+ *
+ * \defgroup xTaskNotify xTaskNotify
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue ) PRIVILEGED_FUNCTION;
+#define xTaskNotify( xTaskToNotify, ulValue, eAction ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL )
+#define xTaskNotifyAndQuery( xTaskToNotify, ulValue, eAction, pulPreviousNotifyValue ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotifyValue ) )
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * A version of xTaskNotify() that can be used from an interrupt service
+ * routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if the notification
+ * unblocked a task with a priority above that of the interrupted task, in
+ * which case a context switch should be requested before the interrupt
+ * exits (see portEND_SWITCHING_ISR()).
+ *
+ * \defgroup xTaskNotifyFromISR xTaskNotifyFromISR
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskGenericNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#define xTaskNotifyFromISR( xTaskToNotify, ulValue, eAction, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL, ( pxHigherPriorityTaskWoken ) )
+#define xTaskNotifyAndQueryFromISR( xTaskToNotify, ulValue, eAction, pulPreviousNotificationValue, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotificationValue ), ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait );</PRE>
+ *
+ * Waits, optionally blocking for up to xTicksToWait, for the calling task to
+ * receive a notification.  Bits set in ulBitsToClearOnEntry are cleared in
+ * the notification value before waiting if no notification is already
+ * pending, and bits set in ulBitsToClearOnExit are cleared after the value
+ * has been copied into *pulNotificationValue (which may be NULL).
+ *
+ * @return pdTRUE if a notification was received (or was already pending),
+ * pdFALSE if the call timed out.
+ *
+ * \defgroup xTaskNotifyWait xTaskNotifyWait
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify );</PRE>
+ *
+ * Increments the notification value of xTaskToNotify, for use as a light
+ * weight and faster binary or counting semaphore in conjunction with
+ * ulTaskNotifyTake().  Always returns pdPASS.
+ *
+ * \defgroup xTaskNotifyGive xTaskNotifyGive
+ * \ingroup TaskNotifications
+ */
+#define xTaskNotifyGive( xTaskToNotify ) xTaskGenericNotify( ( xTaskToNotify ), ( 0 ), eIncrement, NULL )
+
+/**
+ * task. h
+ * <PRE>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * A version of xTaskNotifyGive() that can be used from an interrupt service
+ * routine.  This is the ISR to task signal with the least overhead.
+ *
+ * \defgroup vTaskNotifyGiveFromISR vTaskNotifyGiveFromISR
+ * \ingroup TaskNotifications
+ */
+void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</PRE>
+ *
+ * Waits, optionally blocking for up to xTicksToWait, for the notification
+ * value of the calling task to become non-zero.  On exit the value is either
+ * cleared to zero (xClearCountOnExit != pdFALSE, binary semaphore behaviour)
+ * or decremented (xClearCountOnExit == pdFALSE, counting semaphore behaviour).
+ *
+ * @return The notification value before it was cleared or decremented, so
+ * zero means the call timed out.
+ *
+ * \defgroup ulTaskNotifyTake ulTaskNotifyTake
+ * \ingroup TaskNotifications
+ */
+unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
  *----------------------------------------------------------*/
@@ -1309,6 +1548,22 @@ void vTaskPriorityInherit( xTaskHandle * const pxMutexHolder ) PRIVILEGED_FUNCTI
  */
 void vTaskPriorityDisinherit( xTaskHandle * const pxMutexHolder ) PRIVILEGED_FUNCTION;
 
+/*
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.
+ * Called by the port after a tickless idle period to advance the tick count by
+ * the number of whole tick periods that were suppressed.  The tick hook is not
+ * called for the skipped ticks.
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.
+ * Called by the port from within portSUPPRESS_TICKS_AND_SLEEP(), with
+ * interrupts disabled, to check that nothing made a task ready between the
+ * idle task deciding to sleep and the sleep starting.
+ */
+eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Generic version of the task creation function which is in turn called by the
  * xTaskCreate() and xTaskCreateRestricted() macros.
@@ -0,0 +1,221 @@
+/*
+    FreeRTOS V7.1.1 - Copyright (C) 2012 Real Time Engineers Ltd.
+	
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    ***************************************************************************
+     *                                                                       *
+     *    Having a problem?  Start by reading the FAQ "My application does   *
+     *    not run, what could be wrong?                                      *
+     *                                                                       *
+     *    http://www.FreeRTOS.org/FAQHelp.html                               *
+     *                                                                       *
+    ***************************************************************************
+
+
+    http://www.FreeRTOS.org - Documentation, training, latest information,
+    license and contact details.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool.
+
+    Real Time Engineers ltd license FreeRTOS to High Integrity Systems, who sell
+    the code with commercial support, indemnification, and middleware, under
+    the OpenRTOS brand: http://www.OpenRTOS.com.  High Integrity Systems also
+    provide a safety engineered and independently SIL3 certified version under
+    the SafeRTOS brand: http://www.SafeRTOS.com.
+*/
+
+/*
+ * Fixed size block pools, see mempool.h.
+ *
+ * The free list is a stack of block indexes threaded through the first
+ * bytes of the free blocks.  Updates are made with the GCC __sync compare and
+ * swap builtin, which on the Cortex-M3 becomes an LDREX/STREX loop and never
+ * masks interrupts.
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mempool.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#define memPOOL_INDEX_MASK		( 0xFFFFUL )
+#define memPOOL_COUNTER_STEP	( 0x10000UL )
+
+#define memPOOL_CAS( pulDest, ulOld, ulNew )	__sync_bool_compare_and_swap( ( pulDest ), ( ulOld ), ( ulNew ) )
+
+/*-----------------------------------------------------------*/
+
+static inline unsigned char *prvBlockAt( const xMemPool *pxPool, unsigned long ulIndex )
+{
+	return pxPool->pucStorage + ( ulIndex * pxPool->xBlockSize );
+}
+/*-----------------------------------------------------------*/
+
+void vMemPoolInit( xMemPool *pxPool, void *pvStorage, size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount )
+{
+	configASSERT( ( ( ( portPOINTER_SIZE_TYPE ) pvStorage ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+	configASSERT( uxBlockCount < memPOOL_NO_BLOCK );
+
+	pxPool->pucStorage = ( unsigned char * ) pvStorage;
+	pxPool->xBlockSize = memPOOL_BLOCK_SIZE( xBlockSize );
+	pxPool->uxBlockCount = uxBlockCount;
+	pxPool->ulFreeHead = memPOOL_NO_BLOCK;
+	pxPool->uxUnused = 0;
+	pxPool->uxBlocksTaken = 0;
+}
+/*-----------------------------------------------------------*/
+
+void *pvMemPoolTake( xMemPool *pxPool )
+{
+unsigned long ulHead, ulIndex, ulNext;
+unsigned portBASE_TYPE uxUnused;
+
+	/* Pop the free list.  The link read from the block may be stale if
+	another context took the block meanwhile, but then the head has changed
+	and the swap fails. */
+	do
+	{
+		ulHead = pxPool->ulFreeHead;
+		ulIndex = ulHead & memPOOL_INDEX_MASK;
+		if( ulIndex == memPOOL_NO_BLOCK )
+		{
+			break;
+		}
+		ulNext = *( ( volatile unsigned short * ) prvBlockAt( pxPool, ulIndex ) );
+	} while( memPOOL_CAS( &( pxPool->ulFreeHead ), ulHead, ( ( ulHead + memPOOL_COUNTER_STEP ) & ~memPOOL_INDEX_MASK ) | ulNext ) == pdFALSE );
+
+	if( ulIndex == memPOOL_NO_BLOCK )
+	{
+		/* Nothing was ever given back, hand out the next untouched block. */
+		do
+		{
+			uxUnused = pxPool->uxUnused;
+			if( uxUnused >= pxPool->uxBlockCount )
+			{
+				return NULL;
+			}
+		} while( memPOOL_CAS( &( pxPool->uxUnused ), uxUnused, uxUnused + 1 ) == pdFALSE );
+
+		ulIndex = uxUnused;
+	}
+
+	__sync_fetch_and_add( &( pxPool->uxBlocksTaken ), 1 );
+
+	return prvBlockAt( pxPool, ulIndex );
+}
+/*-----------------------------------------------------------*/
+
+void vMemPoolGive( xMemPool *pxPool, void *pv )
+{
+unsigned long ulHead, ulIndex;
+
+	configASSERT( xMemPoolContains( pxPool, pv ) );
+
+	ulIndex = ( unsigned long ) ( ( ( unsigned char * ) pv ) - pxPool->pucStorage ) / pxPool->xBlockSize;
+
+	do
+	{
+		ulHead = pxPool->ulFreeHead;
+		*( ( volatile unsigned short * ) pv ) = ( unsigned short ) ( ulHead & memPOOL_INDEX_MASK );
+	} while( memPOOL_CAS( &( pxPool->ulFreeHead ), ulHead, ( ( ulHead + memPOOL_COUNTER_STEP ) & ~memPOOL_INDEX_MASK ) | ulIndex ) == pdFALSE );
+
+	__sync_fetch_and_sub( &( pxPool->uxBlocksTaken ), 1 );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xMemPoolContains( const xMemPool *pxPool, const void *pv )
+{
+const unsigned char *puc = ( const unsigned char * ) pv;
+
+	if( ( puc >= pxPool->pucStorage ) && ( puc < prvBlockAt( pxPool, pxPool->uxBlockCount ) ) )
+	{
+		return ( ( ( size_t ) ( puc - pxPool->pucStorage ) ) % pxPool->xBlockSize ) == 0 ? pdTRUE : pdFALSE;
+	}
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void *pvMemPoolTakeOrMalloc( xMemPool *pxPool, size_t xSize )
+{
+void *pvReturn = NULL;
+
+	if( xSize <= pxPool->xBlockSize )
+	{
+		pvReturn = pvMemPoolTake( pxPool );
+	}
+
+	if( pvReturn == NULL )
+	{
+		/* Charge the block to the kernel function that wants the object, not
+		to this wrapper.  Nothing may allocate in between. */
+		vTaskSuspendAll();
+		{
+			traceMALLOC_ON_BEHALF_OF( __builtin_return_address( 0 ) );
+			pvReturn = pvPortMalloc( xSize );
+		}
+		xTaskResumeAll();
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vMemPoolGiveOrFree( xMemPool *pxPool, void *pv )
+{
+	if( xMemPoolContains( pxPool, pv ) != pdFALSE )
+	{
+		vMemPoolGive( pxPool, pv );
+	}
+	else
+	{
+		vPortFree( pv );
+	}
+}
+
@@ -0,0 +1,380 @@
+/*
+    FreeRTOS V7.1.1 - Copyright (C) 2012 Real Time Engineers Ltd.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    See the FreeRTOS license exception at http://www.freertos.org/a00114.html.
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the Linux/POSIX
+ * simulator.
+ *----------------------------------------------------------*/
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Size of the host stack given to each task thread.  The FreeRTOS stack of
+the task only holds the xThreadState structure below. */
+#define portTHREAD_STACK_SIZE		( 256 * 1024 )
+
+/* The signals used to simulate the tick and peripheral interrupts. */
+#define portSIGNAL_TICK				SIGALRM
+#define portSIGNAL_INTERRUPT		SIGUSR1
+
+/* Each task is executed by its own thread.  The thread waits on xWakeup
+until the scheduler selects its task, and the thread that is switched out
+posts the wakeup of the next one before waiting on its own, so exactly one
+task thread runs at any time. */
+typedef struct
+{
+	pthread_t xThread;
+	sem_t xWakeup;
+	pdTASK_CODE pxCode;
+	void *pvParameters;
+} xThreadState;
+
+/* The critical nesting count of the running task.  Context switches only
+happen at nesting zero, so one variable serves all tasks.  Non-zero until the
+scheduler starts so interrupts stay off during initialisation. */
+static volatile unsigned portBASE_TYPE uxCriticalNesting = 9999UL;
+
+/* Set when a yield is requested from inside a critical section or from a
+simulated interrupt.  The switch happens when that section or interrupt
+ends, as a pended PendSV would on the Cortex-M3. */
+static volatile portBASE_TYPE xPendingYield = pdFALSE;
+
+/* Signals that stand for interrupts. */
+static sigset_t xInterruptSignals;
+
+/* Handler installed with vPortSetInterruptHandler(). */
+static void ( *pvInterruptHandler )( void ) = NULL;
+
+/* Posted by vPortEndScheduler() to release the thread that called
+vTaskStartScheduler(). */
+static sem_t xSchedulerEnd;
+
+/* The first member of a TCB is pxTopOfStack, which for this port points to
+the xThreadState of the task. */
+extern void * volatile pxCurrentTCB;
+#define prvGetThreadState( pxTCB )	( *( xThreadState ** ) ( pxTCB ) )
+
+/*
+ * Entry point of every task thread.
+ */
+static void *prvThreadEntry( void *pvParameters );
+
+/*
+ * Select the next task and hand the processor over to its thread.  Must be
+ * called with the interrupt signals blocked.
+ */
+static void prvSwitchContext( void );
+
+/*
+ * Simulated tick and peripheral interrupts.
+ */
+static void prvTickSignalHandler( int iSignal );
+static void prvInterruptSignalHandler( int iSignal );
+
+/*-----------------------------------------------------------*/
+
+static void prvWait( sem_t *pxSemaphore )
+{
+	while( sem_wait( pxSemaphore ) != 0 )
+	{
+		/* Interrupted by a signal, keep waiting. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+xThreadState *pxThreadState;
+pthread_attr_t xAttr;
+sigset_t xOldMask;
+
+	/* The thread state lives at the top of the task stack, the rest of the
+	stack is not used as the thread has a host stack of its own. */
+	pxThreadState = ( xThreadState * ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxTopOfStack + 1 ) - sizeof( xThreadState ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+	pxThreadState->pxCode = pxCode;
+	pxThreadState->pvParameters = pvParameters;
+	sem_init( &pxThreadState->xWakeup, 0, 0 );
+
+	/* Threads inherit the signal mask of their creator.  Create the thread
+	with interrupts blocked so the tick is only ever taken by the thread of
+	the running task. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOldMask );
+	pthread_attr_init( &xAttr );
+	pthread_attr_setstacksize( &xAttr, portTHREAD_STACK_SIZE );
+	pthread_create( &pxThreadState->xThread, &xAttr, prvThreadEntry, pxThreadState );
+	pthread_attr_destroy( &xAttr );
+	pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+
+	return ( portSTACK_TYPE * ) pxThreadState;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParameters )
+{
+xThreadState *pxThreadState = ( xThreadState * ) pvParameters;
+
+	/* Wait until the scheduler selects this task for the first time. */
+	prvWait( &pxThreadState->xWakeup );
+	vPortEnableInterrupts();
+
+	pxThreadState->pxCode( pxThreadState->pvParameters );
+
+	/* Tasks must not return. */
+	vTaskDelete( NULL );
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( void )
+{
+xThreadState *pxOld, *pxNew;
+
+	xPendingYield = pdFALSE;
+
+	pxOld = prvGetThreadState( pxCurrentTCB );
+	vTaskSwitchContext();
+	pxNew = prvGetThreadState( pxCurrentTCB );
+
+	if( pxOld != pxNew )
+	{
+		sem_post( &pxNew->xWakeup );
+		prvWait( &pxOld->xWakeup );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalHandler( int iSignal )
+{
+int iSavedErrno = errno;
+
+	( void ) iSignal;
+
+	/* The handler runs with the interrupt signals blocked, just like an
+	interrupt at the kernel priority. */
+	vTaskIncrementTick();
+
+	/* If using preemption, also force a context switch. */
+	#if configUSE_PREEMPTION == 1
+		xPendingYield = pdTRUE;
+	#endif
+
+	if( xPendingYield != pdFALSE )
+	{
+		prvSwitchContext();
+	}
+
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptSignalHandler( int iSignal )
+{
+int iSavedErrno = errno;
+
+	( void ) iSignal;
+
+	if( pvInterruptHandler != NULL )
+	{
+		pvInterruptHandler();
+	}
+
+	/* Switch if the handler asked for it with portEND_SWITCHING_ISR(). */
+	if( xPendingYield != pdFALSE )
+	{
+		prvSwitchContext();
+	}
+
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( void (*pvHandler)( void ) )
+{
+struct sigaction xAction;
+
+	pvInterruptHandler = pvHandler;
+
+	xAction.sa_handler = prvInterruptSignalHandler;
+	xAction.sa_mask = xInterruptSignals;
+	xAction.sa_flags = SA_RESTART;
+	sigaction( portSIGNAL_INTERRUPT, &xAction, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( void )
+{
+	/* Taken straight away unless the caller is in a critical section, in
+	which case it stays pending until the section ends. */
+	pthread_kill( pthread_self(), portSIGNAL_INTERRUPT );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portBASE_TYPE xPortStartScheduler( void )
+{
+struct sigaction xAction;
+struct itimerval xTimer;
+
+	sem_init( &xSchedulerEnd, 0, 0 );
+
+	/* From here on this thread only waits for the scheduler to end, keep the
+	tick away from it. */
+	vPortDisableInterrupts();
+
+	xAction.sa_handler = prvTickSignalHandler;
+	xAction.sa_mask = xInterruptSignals;
+	xAction.sa_flags = SA_RESTART;
+	sigaction( portSIGNAL_TICK, &xAction, NULL );
+
+	/* Start the timer that generates the tick signal. */
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = portTICK_RATE_MS * 1000;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	/* Initialise the critical nesting count ready for the first task. */
+	uxCriticalNesting = 0;
+
+	/* Start the first task. */
+	sem_post( &prvGetThreadState( pxCurrentTCB )->xWakeup );
+	prvWait( &xSchedulerEnd );
+
+	/* Only get here if a task called vTaskEndScheduler(). */
+	xTimer.it_interval.tv_usec = 0;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	/* Release the thread blocked in xPortStartScheduler().  The calling task
+	stays where it is. */
+	sem_post( &xSchedulerEnd );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	if( uxCriticalNesting == 0 )
+	{
+		vPortDisableInterrupts();
+		prvSwitchContext();
+		vPortEnableInterrupts();
+	}
+	else
+	{
+		xPendingYield = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	/* Switch when the simulated interrupt returns. */
+	xPendingYield = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+	{
+	sigset_t xWaitMask;
+
+		( void ) xExpectedIdleTime;
+
+		/* The scheduler is suspended, so any tick that arrives while asleep
+		is held in the kernel's missed tick count, and an interrupt that makes
+		a task ready ends the sleep.  Check nothing became ready before the
+		signals were blocked, then wait for the next one atomically. */
+		vPortDisableInterrupts();
+
+		if( eTaskConfirmSleepModeStatus() != eAbortSleep )
+		{
+			pthread_sigmask( SIG_BLOCK, NULL, &xWaitMask );
+			sigdelset( &xWaitMask, portSIGNAL_TICK );
+			sigdelset( &xWaitMask, portSIGNAL_INTERRUPT );
+			sigsuspend( &xWaitMask );
+		}
+
+		vPortEnableInterrupts();
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	portDISABLE_INTERRUPTS();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		/* Perform a yield that was requested inside the critical section. */
+		if( xPendingYield != pdFALSE )
+		{
+			prvSwitchContext();
+		}
+		portENABLE_INTERRUPTS();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDeleteThread( void *pvTaskToDelete )
+{
+xThreadState *pxThreadState = prvGetThreadState( pvTaskToDelete );
+
+	/* The thread of a deleted task is parked in prvWait(), which is a
+	cancellation point. */
+	pthread_cancel( pxThreadState->xThread );
+	pthread_join( pxThreadState->xThread, NULL );
+	sem_destroy( &pxThreadState->xWakeup );
+}
+/*-----------------------------------------------------------*/
+
+__attribute__((constructor)) static void prvInitialiseInterruptSignals( void )
+{
+	sigemptyset( &xInterruptSignals );
+	sigaddset( &xInterruptSignals, portSIGNAL_TICK );
+	sigaddset( &xInterruptSignals, portSIGNAL_INTERRUPT );
+}
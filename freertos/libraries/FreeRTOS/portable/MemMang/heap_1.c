@@ -97,6 +97,9 @@ static union xRTOS_HEAP
 } xHeap;
 
 static size_t xNextFreeByte = ( size_t ) 0;
+
+/* The number of blocks handed out, for vPortGetHeapStats(). */
+static size_t xNumberOfSuccessfulAllocations = 0;
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
@@ -122,7 +125,10 @@ void *pvReturn = NULL;
 			block. */
 			pvReturn = &( xHeap.ucHeap[ xNextFreeByte ] );
 			xNextFreeByte += xWantedSize;			
+			xNumberOfSuccessfulAllocations++;
 		}	
+
+		traceMALLOC( pvReturn, xWantedSize );
 	}
 	xTaskResumeAll();
 	
@@ -160,6 +166,43 @@ size_t xPortGetFreeHeapSize( void )
 {
 	return ( configTOTAL_HEAP_SIZE - xNextFreeByte );
 }
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	/* Nothing is ever freed, so the heap never had more free than now. */
+	return xPortGetFreeHeapSize();
+}
+/*-----------------------------------------------------------*/
 
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+unsigned portBASE_TYPE uxBucket;
+size_t xSize;
 
+	vTaskSuspendAll();
+	{
+		xSize = xPortGetFreeHeapSize();
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+	}
+	xTaskResumeAll();
+
+	/* The unused end of the array is the one and only free block. */
+	pxHeapStats->xAvailableHeapSpaceInBytes = xSize;
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = xSize;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xSize;
+	pxHeapStats->xNumberOfFreeBlocks = 1;
+	pxHeapStats->xMinimumEverFreeBytesRemaining = xSize;
+	pxHeapStats->xNumberOfSuccessfulFrees = 0;
+
+	for( uxBucket = 0; uxBucket < portHEAP_HISTOGRAM_BUCKETS; uxBucket++ )
+	{
+		pxHeapStats->xFreeBlockHistogram[ uxBucket ] = 0;
+	}
+	for( uxBucket = 0; ( uxBucket < ( portHEAP_HISTOGRAM_BUCKETS - 1 ) ) && ( xSize >= ( ( size_t ) 32 << uxBucket ) ); uxBucket++ )
+	{
+		/* Find the bucket. */
+	}
+	pxHeapStats->xFreeBlockHistogram[ uxBucket ] = 1;
+}
 
@@ -115,6 +115,17 @@ static xBlockLink xStart, xEnd;
 fragmentation. */
 static size_t xFreeBytesRemaining = configTOTAL_HEAP_SIZE;
 
+/* The low water mark of xFreeBytesRemaining, and how many blocks have been
+handed out and returned, for vPortGetHeapStats(). */
+static size_t xMinimumEverFreeBytesRemaining = configTOTAL_HEAP_SIZE;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+/*
+ * Map a free block size to its xFreeBlockHistogram bucket.
+ */
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize );
+
 /* STATIC FUNCTIONS ARE DEFINED AS MACROS TO MINIMIZE THE FUNCTION CALL DEPTH. */
 
 /*
@@ -235,8 +246,15 @@ void *pvReturn = NULL;
 				}
 				
 				xFreeBytesRemaining -= pxBlock->xBlockSize;
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				xNumberOfSuccessfulAllocations++;
 			}
 		}
+
+		traceMALLOC( pvReturn, xWantedSize );
 	}
 	xTaskResumeAll();
 
@@ -273,6 +291,8 @@ xBlockLink *pxLink;
 			/* Add this block to the list of free blocks. */
 			prvInsertBlockIntoFreeList( ( ( xBlockLink * ) pxLink ) );
 			xFreeBytesRemaining += pxLink->xBlockSize;
+			xNumberOfSuccessfulFrees++;
+			traceFREE( pv, pxLink->xBlockSize );
 		}
 		xTaskResumeAll();
 	}
@@ -285,7 +305,71 @@ size_t xPortGetFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+xBlockLink *pxBlock;
+size_t xSize;
+unsigned portBASE_TYPE uxBucket;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+	for( uxBucket = 0; uxBucket < portHEAP_HISTOGRAM_BUCKETS; uxBucket++ )
+	{
+		pxHeapStats->xFreeBlockHistogram[ uxBucket ] = 0;
+	}
+
+	vTaskSuspendAll();
+	{
+		/* The free list is empty until the first allocation sets it up. */
+		if( xStart.pxNextFreeBlock != NULL )
+		{
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != &xEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				xSize = pxBlock->xBlockSize;
+
+				if( pxHeapStats->xNumberOfFreeBlocks == 0 || xSize < pxHeapStats->xSizeOfSmallestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xSize;
+				}
+				if( xSize > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfLargestFreeBlockInBytes = xSize;
+				}
+				pxHeapStats->xNumberOfFreeBlocks++;
+				pxHeapStats->xFreeBlockHistogram[ prvHistogramBucket( xSize ) ]++;
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
 }
+/*-----------------------------------------------------------*/
+
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize )
+{
+unsigned portBASE_TYPE uxBucket = 0;
+
+	while( ( uxBucket < ( portHEAP_HISTOGRAM_BUCKETS - 1 ) ) && ( xBlockSize >= ( ( size_t ) 32 << uxBucket ) ) )
+	{
+		uxBucket++;
+	}
+
+	return uxBucket;
+}
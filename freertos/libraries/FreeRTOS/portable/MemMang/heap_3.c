@@ -88,15 +88,51 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+/* The C library does not say how big a block is once it has been handed out,
+so each one is preceded by its size, padded to keep the block aligned.  The
+size, header included, is needed to account for the block when it is freed. */
+typedef union A_BLOCK_HEADER
+{
+	size_t xBlockSize;
+	unsigned char ucAlignment[ portBYTE_ALIGNMENT ];
+} xBlockHeader;
+
+#define heapHEADER_SIZE		sizeof( xBlockHeader )
+
+/* The C library's heap has no fixed size, so the free figures are against
+configTOTAL_HEAP_SIZE taken as a budget: what is left of it after the bytes
+handed out.  They go below zero as zero.  Nothing is known of fragmentation. */
+static size_t xBytesAllocated = 0;
+static size_t xMaximumEverBytesAllocated = 0;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+static size_t prvFreeBytes( size_t xAllocated );
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
 {
-void *pvReturn;
+void *pvReturn = NULL;
+xBlockHeader *pxHeader;
 
 	vTaskSuspendAll();
 	{
-		pvReturn = malloc( xWantedSize );
+		xWantedSize += heapHEADER_SIZE;
+		pxHeader = malloc( xWantedSize );
+		if( pxHeader != NULL )
+		{
+			pxHeader->xBlockSize = xWantedSize;
+			pvReturn = ( void * ) ( ( ( unsigned char * ) pxHeader ) + heapHEADER_SIZE );
+
+			xBytesAllocated += pxHeader->xBlockSize;
+			if( xBytesAllocated > xMaximumEverBytesAllocated )
+			{
+				xMaximumEverBytesAllocated = xBytesAllocated;
+			}
+			xNumberOfSuccessfulAllocations++;
+		}
+		traceMALLOC( pvReturn, xWantedSize );
 	}
 	xTaskResumeAll();
 
@@ -116,15 +152,70 @@ void *pvReturn;
 
 void vPortFree( void *pv )
 {
+xBlockHeader *pxHeader;
+
 	if( pv )
 	{
+		pxHeader = ( xBlockHeader * ) ( ( ( unsigned char * ) pv ) - heapHEADER_SIZE );
+
 		vTaskSuspendAll();
 		{
-			free( pv );
+			xBytesAllocated -= pxHeader->xBlockSize;
+			xNumberOfSuccessfulFrees++;
+			traceFREE( pv, pxHeader->xBlockSize );
+			free( pxHeader );
 		}
 		xTaskResumeAll();
 	}
 }
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return prvFreeBytes( xBytesAllocated );
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return prvFreeBytes( xMaximumEverBytesAllocated );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+unsigned portBASE_TYPE uxBucket;
+
+	/* The free blocks belong to the C library, none are reported. */
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+	for( uxBucket = 0; uxBucket < portHEAP_HISTOGRAM_BUCKETS; uxBucket++ )
+	{
+		pxHeapStats->xFreeBlockHistogram[ uxBucket ] = 0;
+	}
+
+	vTaskSuspendAll();
+	{
+		pxHeapStats->xAvailableHeapSpaceInBytes = prvFreeBytes( xBytesAllocated );
+		pxHeapStats->xMinimumEverFreeBytesRemaining = prvFreeBytes( xMaximumEverBytesAllocated );
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFreeBytes( size_t xAllocated )
+{
+	return xAllocated < configTOTAL_HEAP_SIZE ? configTOTAL_HEAP_SIZE - xAllocated : 0;
+}
 
 
 
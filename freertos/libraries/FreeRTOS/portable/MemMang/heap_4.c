@@ -118,6 +118,11 @@ static void prvInsertBlockIntoFreeList( xBlockLink *pxBlockToInsert );
  */
 static void prvHeapInit( void );
 
+/*
+ * Map a free block size to its xFreeBlockHistogram bucket.
+ */
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize );
+
 /*-----------------------------------------------------------*/
 
 /* The size of the structure placed at the beginning of each allocated memory
@@ -140,6 +145,12 @@ application.  When the bit is free the block is still part of the free heap
 space. */
 static size_t xBlockAllocatedBit = 0;
 
+/* The low water mark of xFreeBytesRemaining, and how many blocks have been
+handed out and returned, for vPortGetHeapStats(). */
+static size_t xMinimumEverFreeBytesRemaining = ( ( size_t ) heapADJUSTED_HEAP_SIZE ) & ( ( size_t ) ~portBYTE_ALIGNMENT_MASK );
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
@@ -221,6 +232,11 @@ void *pvReturn = NULL;
 					}
 
 					xFreeBytesRemaining -= pxBlock->xBlockSize;
+					if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+					{
+						xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+					}
+					xNumberOfSuccessfulAllocations++;
 
 					/* The block is being returned - it is allocated and owned
 					by the application and has no "next" block. */
@@ -229,6 +245,8 @@ void *pvReturn = NULL;
 				}
 			}
 		}
+
+		traceMALLOC( pvReturn, xWantedSize );
 	}
 	xTaskResumeAll();
 
@@ -275,7 +293,9 @@ xBlockLink *pxLink;
 				vTaskSuspendAll();
 				{
 					/* Add this block to the list of free blocks. */
+					traceFREE( pv, pxLink->xBlockSize );
 					xFreeBytesRemaining += pxLink->xBlockSize;
+					xNumberOfSuccessfulFrees++;
 					prvInsertBlockIntoFreeList( ( ( xBlockLink * ) pxLink ) );
 				}
 				xTaskResumeAll();
@@ -291,6 +311,57 @@ size_t xPortGetFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+xBlockLink *pxBlock;
+size_t xSize;
+unsigned portBASE_TYPE uxBucket;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+	for( uxBucket = 0; uxBucket < portHEAP_HISTOGRAM_BUCKETS; uxBucket++ )
+	{
+		pxHeapStats->xFreeBlockHistogram[ uxBucket ] = 0;
+	}
+
+	vTaskSuspendAll();
+	{
+		/* The free list is empty until the first allocation sets it up. */
+		if( pxEnd != NULL )
+		{
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				xSize = pxBlock->xBlockSize;
+
+				if( pxHeapStats->xNumberOfFreeBlocks == 0 || xSize < pxHeapStats->xSizeOfSmallestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xSize;
+				}
+				if( xSize > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfLargestFreeBlockInBytes = xSize;
+				}
+				pxHeapStats->xNumberOfFreeBlocks++;
+				pxHeapStats->xFreeBlockHistogram[ prvHistogramBucket( xSize ) ]++;
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
@@ -327,6 +398,7 @@ unsigned char *pucHeapEnd, *pucAlignedHeap;
 
 	/* The heap now contains pxEnd. */
 	xFreeBytesRemaining -= heapSTRUCT_SIZE;
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
 
 	/* Work out the position of the top bit in a size_t variable. */
 	xBlockAllocatedBit = ( ( size_t ) 1 ) << ( ( sizeof( size_t ) * heapBITS_PER_BYTE ) - 1 );
@@ -384,4 +456,17 @@ unsigned char *puc;
 		pxIterator->pxNextFreeBlock = pxBlockToInsert;
 	}
 }
+/*-----------------------------------------------------------*/
+
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize )
+{
+unsigned portBASE_TYPE uxBucket = 0;
+
+	while( ( uxBucket < ( portHEAP_HISTOGRAM_BUCKETS - 1 ) ) && ( xBlockSize >= ( ( size_t ) 32 << uxBucket ) ) )
+	{
+		uxBucket++;
+	}
+
+	return uxBucket;
+}
 
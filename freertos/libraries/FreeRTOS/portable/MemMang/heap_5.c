@@ -0,0 +1,623 @@
+/*
+    FreeRTOS V7.5.2 - Copyright (C) 2013 Real Time Engineers Ltd.
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that has become a de facto standard.             *
+     *                                                                       *
+     *    Help yourself get started quickly and support the FreeRTOS         *
+     *    project by purchasing a FreeRTOS tutorial book, reference          *
+     *    manual, or both from: http://www.FreeRTOS.org/Documentation        *
+     *                                                                       *
+     *    Thank you!                                                         *
+     *                                                                       *
+    ***************************************************************************
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>!AND MODIFIED BY!<< the FreeRTOS exception.
+
+    >>! NOTE: The modification to the GPL is included to allow you to distribute
+    >>! a combined work that includes FreeRTOS without being obliged to provide
+    >>! the source code for proprietary components outside of the FreeRTOS
+    >>! kernel.
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available from the following
+    link: http://www.freertos.org/a00114.html
+
+    1 tab == 4 spaces!
+
+    ***************************************************************************
+     *                                                                       *
+     *    Having a problem?  Start by reading the FAQ "My application does   *
+     *    not run, what could be wrong?"                                     *
+     *                                                                       *
+     *    http://www.FreeRTOS.org/FAQHelp.html                               *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org - Documentation, books, training, latest versions,
+    license and Real Time Engineers Ltd. contact details.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd license FreeRTOS to High
+    Integrity Systems to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * A sample implementation of pvPortMalloc() and vPortFree() that works like
+ * heap_4.c - first fit from a list of free blocks kept in address order, with
+ * freed blocks merged with their neighbours - but over several regions of
+ * memory that need not be contiguous, such as the internal SRAM and an
+ * external SRAM behind the FSMC.
+ *
+ * The configTOTAL_HEAP_SIZE byte array is always the first region and counts
+ * as fast memory.  vPortDefineHeapRegions() adds more, and must be called
+ * before the first allocation.  Requests of up to
+ * configHEAP_FAST_ALLOCATION_LIMIT bytes look for a block in the fast regions
+ * first, larger ones in the slow regions first, so small frequently used
+ * objects stay in internal SRAM and big buffers go to external memory.  Either
+ * kind falls back to the other when its preferred regions are full.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c, heap_4.c and heap_tlsf.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Requests of up to this many bytes prefer the fast regions, larger ones the
+slow regions.  0 turns the preference off, blocks are then taken in address
+order like heap_4.c. */
+#ifndef configHEAP_FAST_ALLOCATION_LIMIT
+	#define configHEAP_FAST_ALLOCATION_LIMIT	256
+#endif
+
+/* The most regions the heap can span, including the built in one. */
+#ifndef configHEAP_MAX_REGIONS
+	#define configHEAP_MAX_REGIONS	4
+#endif
+
+/* Block sizes must not get too small. */
+#define heapMINIMUM_BLOCK_SIZE	( ( size_t ) ( heapSTRUCT_SIZE * 2 ) )
+
+/* Assumes 8bit bytes! */
+#define heapBITS_PER_BYTE		( ( size_t ) 8 )
+
+/* Allocate the memory for the built in region, aligned so that its usable
+size is known before the heap is laid out. */
+static unsigned char ucHeap[ configTOTAL_HEAP_SIZE ] __attribute__ ( ( aligned( portBYTE_ALIGNMENT ) ) );
+
+/* Define the linked list structure.  This is used to link free blocks in order
+of their memory address. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the list. */
+	size_t xBlockSize;						/*<< The size of the free block. */
+} xBlockLink;
+
+/* The free space the built in region holds once laid out: all of it, aligned
+down, less its end marker. */
+#define heapBUILT_IN_FREE_SIZE	( ( ( size_t ) configTOTAL_HEAP_SIZE & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) - ( ( sizeof( xBlockLink ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) )
+
+/* The bounds of a region once it has been aligned, to tell which kind of
+memory a free block is in. */
+typedef struct HEAP_SPAN
+{
+	unsigned char *pucStart;
+	unsigned char *pucEnd;
+	portBASE_TYPE xFast;
+} xHeapSpan;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Inserts a block of memory that is being freed into the correct position in 
+ * the list of free memory blocks.  The block being freed will be merged with
+ * the block in front it and/or the block behind it if the memory blocks are
+ * adjacent to each other.
+ */
+static void prvInsertBlockIntoFreeList( xBlockLink *pxBlockToInsert );
+
+/*
+ * Sets up the free list over the built in region and those in pxHeapRegions,
+ * which may be NULL.  Called by vPortDefineHeapRegions(), or automatically the
+ * first time the heap is used if that was never called.
+ */
+static void prvHeapInit( const xHeapRegionType *pxHeapRegions );
+
+/*
+ * Returns pdTRUE if pxBlock lies in a fast region.
+ */
+static portBASE_TYPE prvBlockIsFast( const xBlockLink *pxBlock );
+
+/*
+ * Map a free block size to its xFreeBlockHistogram bucket.
+ */
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize );
+
+/*-----------------------------------------------------------*/
+
+/* The size of the structure placed at the beginning of each allocated memory
+block must by correctly byte aligned. */
+static const unsigned short heapSTRUCT_SIZE	= ( ( sizeof ( xBlockLink ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~portBYTE_ALIGNMENT_MASK );
+
+/* xStart heads the list of free blocks.  Every region ends in a zero sized
+marker block that stays on the list, the last of them is pxEnd. */
+static xBlockLink xStart, *pxEnd = NULL;
+
+/* The regions in address order. */
+static xHeapSpan xSpans[ configHEAP_MAX_REGIONS ];
+static unsigned portBASE_TYPE uxSpans = 0;
+
+/* pdTRUE when there are both fast and slow regions, only then is it worth
+looking for a block in the preferred kind first. */
+static portBASE_TYPE xMixedRegions = pdFALSE;
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation.  It starts out as the built in region, prvHeapInit() adds any
+others. */
+static size_t xFreeBytesRemaining = heapBUILT_IN_FREE_SIZE;
+
+/* Gets set to the top bit of an size_t type.  When this bit in the xBlockSize 
+member of an xBlockLink structure is set then the block belongs to the 
+application.  When the bit is free the block is still part of the free heap
+space. */
+static size_t xBlockAllocatedBit = 0;
+
+/* The low water mark of xFreeBytesRemaining, and how many blocks have been
+handed out and returned, for vPortGetHeapStats(). */
+static size_t xMinimumEverFreeBytesRemaining = heapBUILT_IN_FREE_SIZE;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const xHeapRegionType * const pxHeapRegions )
+{
+	/* The regions can only be laid out before anything is allocated. */
+	configASSERT( pxEnd == NULL );
+
+	vTaskSuspendAll();
+	{
+		if( pxEnd == NULL )
+		{
+			prvHeapInit( pxHeapRegions );
+		}
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+xBlockLink *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
+portBASE_TYPE xPreferFast, xPass;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc and no regions were defined
+		then the heap is just the built in region. */
+		if( pxEnd == NULL )
+		{
+			prvHeapInit( NULL );
+		}
+
+		/* Check the requested block size is not so large that the top bit is
+		set.  The top bit of the block size member of the xBlockLink structure 
+		is used to determine who owns the block - the application or the
+		kernel, so it must be free. */
+		if( ( xWantedSize & xBlockAllocatedBit ) == 0 )
+		{
+			xPreferFast = ( xWantedSize <= ( size_t ) configHEAP_FAST_ALLOCATION_LIMIT ) ? pdTRUE : pdFALSE;
+
+			/* The wanted size is increased so it can contain a xBlockLink
+			structure in addition to the requested amount of bytes. */
+			if( xWantedSize > 0 )
+			{
+				xWantedSize += heapSTRUCT_SIZE;
+
+				/* Ensure that blocks are always aligned to the required number 
+				of bytes. */
+				if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+				{
+					/* Byte alignment required. */
+					xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+				}
+			}
+
+			if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+			{
+				/* Traverse the list from the start (lowest address) block until
+				one of adequate size is found - on the first pass only in the
+				preferred kind of region, on the second anywhere.  The region
+				end markers are never big enough. */
+				xPass = ( ( xMixedRegions != pdFALSE ) && ( configHEAP_FAST_ALLOCATION_LIMIT > 0 ) ) ? 0 : 1;
+				for( ; xPass < 2; xPass++ )
+				{
+					pxPreviousBlock = &xStart;
+					pxBlock = xStart.pxNextFreeBlock;
+					while( pxBlock != pxEnd )
+					{
+						if( ( pxBlock->xBlockSize >= xWantedSize ) && ( ( xPass != 0 ) || ( prvBlockIsFast( pxBlock ) == xPreferFast ) ) )
+						{
+							break;
+						}
+
+						pxPreviousBlock = pxBlock;
+						pxBlock = pxBlock->pxNextFreeBlock;
+					}
+
+					if( pxBlock != pxEnd )
+					{
+						break;
+					}
+				}
+
+				/* If the end marker was reached then a block of adequate size 
+				was	not found. */
+				if( pxBlock != pxEnd )
+				{
+					/* Return the memory space pointed to - jumping over the 
+					xBlockLink structure at its start. */
+					pvReturn = ( void * ) ( ( ( unsigned char * ) pxPreviousBlock->pxNextFreeBlock ) + heapSTRUCT_SIZE );
+
+					/* This block is being returned for use so must be taken out 
+					of the list of free blocks. */
+					pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+
+					/* If the block is larger than required it can be split into 
+					two. */
+					if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+					{
+						/* This block is to be split into two.  Create a new 
+						block following the number of bytes requested. The void 
+						cast is used to prevent byte alignment warnings from the 
+						compiler. */
+						pxNewBlockLink = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+
+						/* Calculate the sizes of two blocks split from the 
+						single block. */
+						pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+						pxBlock->xBlockSize = xWantedSize;
+
+						/* Insert the new block into the list of free blocks. */
+						prvInsertBlockIntoFreeList( ( pxNewBlockLink ) );
+					}
+
+					xFreeBytesRemaining -= pxBlock->xBlockSize;
+					if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+					{
+						xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+					}
+					xNumberOfSuccessfulAllocations++;
+
+					/* The block is being returned - it is allocated and owned
+					by the application and has no "next" block. */
+					pxBlock->xBlockSize |= xBlockAllocatedBit;
+					pxBlock->pxNextFreeBlock = NULL;
+				}
+			}
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+unsigned char *puc = ( unsigned char * ) pv;
+xBlockLink *pxLink;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have an xBlockLink structure immediately
+		before it. */
+		puc -= heapSTRUCT_SIZE;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxLink = ( void * ) puc;
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxLink->xBlockSize & xBlockAllocatedBit ) != 0 );
+		configASSERT( pxLink->pxNextFreeBlock == NULL );
+		
+		if( ( pxLink->xBlockSize & xBlockAllocatedBit ) != 0 )
+		{
+			if( pxLink->pxNextFreeBlock == NULL )
+			{
+				/* The block is being returned to the heap - it is no longer
+				allocated. */
+				pxLink->xBlockSize &= ~xBlockAllocatedBit;
+
+				vTaskSuspendAll();
+				{
+					/* Add this block to the list of free blocks. */
+					traceFREE( pv, pxLink->xBlockSize );
+					xFreeBytesRemaining += pxLink->xBlockSize;
+					xNumberOfSuccessfulFrees++;
+					prvInsertBlockIntoFreeList( ( ( xBlockLink * ) pxLink ) );
+				}
+				xTaskResumeAll();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+xBlockLink *pxBlock;
+size_t xSize;
+unsigned portBASE_TYPE uxBucket;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+	for( uxBucket = 0; uxBucket < portHEAP_HISTOGRAM_BUCKETS; uxBucket++ )
+	{
+		pxHeapStats->xFreeBlockHistogram[ uxBucket ] = 0;
+	}
+
+	vTaskSuspendAll();
+	{
+		/* The free list is empty until the regions are set up. */
+		if( pxEnd != NULL )
+		{
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				xSize = pxBlock->xBlockSize;
+
+				/* Skip the end markers between regions. */
+				if( xSize == 0 )
+				{
+					continue;
+				}
+
+				if( pxHeapStats->xNumberOfFreeBlocks == 0 || xSize < pxHeapStats->xSizeOfSmallestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xSize;
+				}
+				if( xSize > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfLargestFreeBlockInBytes = xSize;
+				}
+				pxHeapStats->xNumberOfFreeBlocks++;
+				pxHeapStats->xFreeBlockHistogram[ prvHistogramBucket( xSize ) ]++;
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( const xHeapRegionType *pxHeapRegions )
+{
+xBlockLink *pxFirstFreeBlock, *pxPreviousFreeBlock;
+unsigned char *pucRegionStart, *pucRegionEnd;
+xHeapSpan xSpan;
+unsigned portBASE_TYPE ux, uxRegion;
+portBASE_TYPE xHaveFast = pdFALSE, xHaveSlow = pdFALSE;
+
+	/* Collect the regions, the built in one first, and sort them by address
+	with an insertion sort - there are only a handful. */
+	pucRegionStart = ucHeap;
+	pucRegionEnd = ucHeap + configTOTAL_HEAP_SIZE;
+	uxRegion = 0;
+	for( ;; )
+	{
+		/* Align the start up and the end down. */
+		xSpan.pucStart = ( unsigned char * ) ( ( ( portPOINTER_SIZE_TYPE ) pucRegionStart + portBYTE_ALIGNMENT_MASK ) & ( ( portPOINTER_SIZE_TYPE ) ~portBYTE_ALIGNMENT_MASK ) );
+		xSpan.pucEnd = ( unsigned char * ) ( ( ( portPOINTER_SIZE_TYPE ) pucRegionEnd ) & ( ( portPOINTER_SIZE_TYPE ) ~portBYTE_ALIGNMENT_MASK ) );
+		xSpan.xFast = ( ( uxRegion == 0 ) || ( pxHeapRegions[ uxRegion - 1 ].xFast != pdFALSE ) ) ? pdTRUE : pdFALSE;
+
+		/* Regions too small to hold a block and the end marker are ignored. */
+		configASSERT( uxSpans < configHEAP_MAX_REGIONS );
+		if( ( uxSpans < configHEAP_MAX_REGIONS ) && ( xSpan.pucEnd > xSpan.pucStart ) && ( ( size_t ) ( xSpan.pucEnd - xSpan.pucStart ) > heapMINIMUM_BLOCK_SIZE + heapSTRUCT_SIZE ) )
+		{
+			for( ux = uxSpans; ( ux > 0 ) && ( xSpans[ ux - 1 ].pucStart > xSpan.pucStart ); ux-- )
+			{
+				xSpans[ ux ] = xSpans[ ux - 1 ];
+			}
+			xSpans[ ux ] = xSpan;
+			uxSpans++;
+		}
+
+		if( ( pxHeapRegions == NULL ) || ( pxHeapRegions[ uxRegion ].pucStartAddress == NULL ) )
+		{
+			break;
+		}
+
+		pucRegionStart = pxHeapRegions[ uxRegion ].pucStartAddress;
+		pucRegionEnd = pucRegionStart + pxHeapRegions[ uxRegion ].xSizeInBytes;
+		uxRegion++;
+	}
+
+	/* Chain the regions together: each holds a single free block followed by
+	its end marker, which links on to the next region's block. */
+	pxPreviousFreeBlock = &xStart;
+	xStart.xBlockSize = ( size_t ) 0;
+	for( ux = 0; ux < uxSpans; ux++ )
+	{
+		/* Regions must not overlap. */
+		configASSERT( ( ux == 0 ) || ( xSpans[ ux ].pucStart >= xSpans[ ux - 1 ].pucEnd ) );
+
+		pxEnd = ( void * ) ( xSpans[ ux ].pucEnd - heapSTRUCT_SIZE );
+		pxEnd->xBlockSize = 0;
+		pxEnd->pxNextFreeBlock = NULL;
+
+		pxFirstFreeBlock = ( void * ) xSpans[ ux ].pucStart;
+		pxFirstFreeBlock->xBlockSize = ( size_t ) ( ( unsigned char * ) pxEnd - xSpans[ ux ].pucStart );
+		pxFirstFreeBlock->pxNextFreeBlock = pxEnd;
+
+		pxPreviousFreeBlock->pxNextFreeBlock = pxFirstFreeBlock;
+		pxPreviousFreeBlock = pxEnd;
+
+		/* The built in region is counted from the start. */
+		if( xSpans[ ux ].pucStart == ucHeap )
+		{
+			configASSERT( pxFirstFreeBlock->xBlockSize == heapBUILT_IN_FREE_SIZE );
+		}
+		else
+		{
+			xFreeBytesRemaining += pxFirstFreeBlock->xBlockSize;
+		}
+
+		if( xSpans[ ux ].xFast != pdFALSE )
+		{
+			xHaveFast = pdTRUE;
+		}
+		else
+		{
+			xHaveSlow = pdTRUE;
+		}
+	}
+
+	xMixedRegions = ( ( xHaveFast != pdFALSE ) && ( xHaveSlow != pdFALSE ) ) ? pdTRUE : pdFALSE;
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+
+	/* Work out the position of the top bit in a size_t variable. */
+	xBlockAllocatedBit = ( ( size_t ) 1 ) << ( ( sizeof( size_t ) * heapBITS_PER_BYTE ) - 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoFreeList( xBlockLink *pxBlockToInsert )
+{
+xBlockLink *pxIterator;
+unsigned char *puc;
+
+	/* Iterate through the list until a block is found that has a higher address
+	than the block being inserted. */
+	for( pxIterator = &xStart; pxIterator->pxNextFreeBlock < pxBlockToInsert; pxIterator = pxIterator->pxNextFreeBlock )
+	{
+		/* Nothing to do here, just iterate to the right position. */
+	}
+
+	/* Do the block being inserted, and the block it is being inserted after
+	make a contiguous block of memory?  An end marker has no size, so a
+	block is never merged into one. */
+	puc = ( unsigned char * ) pxIterator;
+	if( ( pxIterator->xBlockSize != 0 ) && ( ( puc + pxIterator->xBlockSize ) == ( unsigned char * ) pxBlockToInsert ) )
+	{
+		pxIterator->xBlockSize += pxBlockToInsert->xBlockSize;
+		pxBlockToInsert = pxIterator;
+	}
+
+	/* Do the block being inserted, and the block it is being inserted before
+	make a contiguous block of memory?  The end markers are kept on the list
+	so the regions stay apart. */
+	puc = ( unsigned char * ) pxBlockToInsert;
+	if( ( ( puc + pxBlockToInsert->xBlockSize ) == ( unsigned char * ) pxIterator->pxNextFreeBlock ) && ( pxIterator->pxNextFreeBlock->xBlockSize != 0 ) )
+	{
+		/* Form one big block from the two blocks. */
+		pxBlockToInsert->xBlockSize += pxIterator->pxNextFreeBlock->xBlockSize;
+		pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;		
+	}
+
+	/* If the block being inserted plugged a gab, so was merged with the block
+	before and the block after, then it's pxNextFreeBlock pointer will have
+	already been set, and should not be set here as that would make it point
+	to itself. */
+	if( pxIterator != pxBlockToInsert )
+	{
+		pxIterator->pxNextFreeBlock = pxBlockToInsert;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvBlockIsFast( const xBlockLink *pxBlock )
+{
+unsigned portBASE_TYPE ux;
+
+	for( ux = 0; ux < uxSpans; ux++ )
+	{
+		if( ( ( const unsigned char * ) pxBlock >= xSpans[ ux ].pucStart ) && ( ( const unsigned char * ) pxBlock < xSpans[ ux ].pucEnd ) )
+		{
+			return xSpans[ ux ].xFast;
+		}
+	}
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize )
+{
+unsigned portBASE_TYPE uxBucket = 0;
+
+	while( ( uxBucket < ( portHEAP_HISTOGRAM_BUCKETS - 1 ) ) && ( xBlockSize >= ( ( size_t ) 32 << uxBucket ) ) )
+	{
+		uxBucket++;
+	}
+
+	return uxBucket;
+}
@@ -0,0 +1,621 @@
+/*
+    FreeRTOS V7.5.2 - Copyright (C) 2013 Real Time Engineers Ltd.
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that has become a de facto standard.             *
+     *                                                                       *
+     *    Help yourself get started quickly and support the FreeRTOS         *
+     *    project by purchasing a FreeRTOS tutorial book, reference          *
+     *    manual, or both from: http://www.FreeRTOS.org/Documentation        *
+     *                                                                       *
+     *    Thank you!                                                         *
+     *                                                                       *
+    ***************************************************************************
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>!AND MODIFIED BY!<< the FreeRTOS exception.
+
+    >>! NOTE: The modification to the GPL is included to allow you to distribute
+    >>! a combined work that includes FreeRTOS without being obliged to provide
+    >>! the source code for proprietary components outside of the FreeRTOS
+    >>! kernel.
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available from the following
+    link: http://www.freertos.org/a00114.html
+
+    1 tab == 4 spaces!
+
+    ***************************************************************************
+     *                                                                       *
+     *    Having a problem?  Start by reading the FAQ "My application does   *
+     *    not run, what could be wrong?"                                     *
+     *                                                                       *
+     *    http://www.FreeRTOS.org/FAQHelp.html                               *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org - Documentation, books, training, latest versions,
+    license and Real Time Engineers Ltd. contact details.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd license FreeRTOS to High
+    Integrity Systems to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * A two level segregated fit (TLSF) implementation of pvPortMalloc() and
+ * vPortFree().  Free blocks are kept in a table of lists indexed by a coarse
+ * power of two size class and a finer linear subdivision of it, with a bitmap
+ * per level recording which lists are not empty.  Finding a fitting block is a
+ * couple of bit scans, and freed blocks are merged with their physical
+ * neighbours straight away, so both calls take a bounded time no matter how
+ * fragmented the heap has become.
+ *
+ * Requests are rounded up to the start of the next size class so any block
+ * found is big enough - the price is up to 1 / heapSL_INDEX_COUNT of the
+ * request lost to rounding.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c and heap_4.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Blocks smaller than the heap itself must fit in the first level index, the
+default covers heaps below 32K. */
+#ifndef configTLSF_FL_INDEX_MAX
+	#define configTLSF_FL_INDEX_MAX		15
+#endif
+
+/* Each power of two size class is split into 2^heapSL_INDEX_COUNT_LOG2
+lists. */
+#define heapSL_INDEX_COUNT_LOG2		3
+#define heapSL_INDEX_COUNT			( 1 << heapSL_INDEX_COUNT_LOG2 )
+
+#if portBYTE_ALIGNMENT == 8
+	#define heapALIGN_SIZE_LOG2		3
+#elif portBYTE_ALIGNMENT == 4
+	#define heapALIGN_SIZE_LOG2		2
+#else
+	#error heap_tlsf.c needs a portBYTE_ALIGNMENT of 4 or 8
+#endif
+
+/* Blocks below heapSMALL_BLOCK_SIZE all live in the first size class, split
+linearly by the alignment. */
+#define heapFL_INDEX_SHIFT			( heapSL_INDEX_COUNT_LOG2 + heapALIGN_SIZE_LOG2 )
+#define heapFL_INDEX_COUNT			( configTLSF_FL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* The low bits of xSize are free as sizes are multiples of the alignment. */
+#define heapBLOCK_FREE_BIT			( ( size_t ) 1 )
+#define heapBLOCK_SIZE_MASK			( ~( size_t ) portBYTE_ALIGNMENT_MASK )
+
+/* Every block, allocated or free, starts with its size and a link to the
+block physically before it.  Free blocks additionally hold the links of the
+free list they are on, in what is otherwise the start of the payload. */
+typedef struct TLSF_BLOCK
+{
+	struct TLSF_BLOCK *pxPrevPhysBlock;	/*<< The block just below this one in memory. */
+	size_t xSize;						/*<< The size of the block including this header, heapBLOCK_FREE_BIT set while it is free. */
+	struct TLSF_BLOCK *pxNextFree;		/*<< Free list links, only valid while the block is free. */
+	struct TLSF_BLOCK *pxPrevFree;
+} xTlsfBlock;
+
+/* The first and second level bitmaps and the free list heads.  This is carved
+from the start of the heap array so the heap costs no RAM beyond
+configTOTAL_HEAP_SIZE. */
+typedef struct TLSF_CONTROL
+{
+	unsigned long ulFlBitmap;
+	unsigned long ulSlBitmap[ heapFL_INDEX_COUNT ];
+	xTlsfBlock *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+} xTlsfControl;
+
+/* Allocate the memory for the heap. */
+static unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+
+/* Refuse to build if the first level index cannot describe the whole heap. */
+typedef char xTlsfHeapFitsIndex[ ( configTOTAL_HEAP_SIZE < ( ( size_t ) 1 << configTLSF_FL_INDEX_MAX ) ) ? 1 : -1 ];
+
+/* The size of the part of a block header that is kept while it is allocated,
+and the smallest block that can hold a whole free block header. */
+static const size_t heapBLOCK_OVERHEAD = ( ( sizeof( xTlsfBlock * ) + sizeof( size_t ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) );
+static const size_t heapMINIMUM_BLOCK_SIZE = ( ( sizeof( xTlsfBlock ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) );
+
+static xTlsfControl *pxControl = NULL;
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation. */
+static size_t xFreeBytesRemaining = 0;
+
+/* The low water mark of xFreeBytesRemaining, and how many blocks have been
+handed out and returned, for vPortGetHeapStats(). */
+static size_t xMinimumEverFreeBytesRemaining = 0;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() or one of the heap figures is asked for.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Lay the heap out now if nothing has allocated yet, so the free figures are
+ * right before the first pvPortMalloc().
+ */
+static void prvHeapInitIfNeeded( void );
+
+/*
+ * Map a block size to the free list that holds blocks of that size, and a
+ * request size to the first list whose blocks are all large enough.
+ */
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFl, unsigned portBASE_TYPE *puxSl );
+static void prvMappingSearch( size_t xSize, unsigned portBASE_TYPE *puxFl, unsigned portBASE_TYPE *puxSl );
+
+/*
+ * Return a free block of at least xSize bytes, or NULL if there is none.
+ */
+static xTlsfBlock *prvFindFreeBlock( size_t xSize );
+
+/*
+ * Add a free block to / remove it from the free list its size maps to.
+ */
+static void prvInsertFreeBlock( xTlsfBlock *pxBlock );
+static void prvRemoveFreeBlock( xTlsfBlock *pxBlock );
+
+/*
+ * Map a free block size to its xFreeBlockHistogram bucket.
+ */
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize );
+
+/*-----------------------------------------------------------*/
+
+/* Bit scans, the GCC builtins compile to CLZ (and RBIT) on the Cortex-M3. */
+static inline unsigned portBASE_TYPE prvFls( size_t x )
+{
+	return ( sizeof( unsigned long ) * 8 - 1 ) - __builtin_clzl( ( unsigned long ) x );
+}
+
+static inline unsigned portBASE_TYPE prvFfs( unsigned long x )
+{
+	return __builtin_ctzl( x );
+}
+
+static inline size_t prvBlockSize( const xTlsfBlock *pxBlock )
+{
+	return pxBlock->xSize & heapBLOCK_SIZE_MASK;
+}
+
+static inline xTlsfBlock *prvNextPhysBlock( const xTlsfBlock *pxBlock )
+{
+	return ( xTlsfBlock * ) ( ( ( unsigned char * ) pxBlock ) + prvBlockSize( pxBlock ) );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+xTlsfBlock *pxBlock, *pxNewBlock;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the list of free blocks. */
+		if( pxControl == NULL )
+		{
+			prvHeapInit();
+		}
+
+		/* Room for the header, rounded to the alignment, and at least enough
+		to hold the free list links once the block is freed again. */
+		if( ( xWantedSize > 0 ) && ( xWantedSize < configTOTAL_HEAP_SIZE ) )
+		{
+			xWantedSize = ( xWantedSize + heapBLOCK_OVERHEAD + portBYTE_ALIGNMENT_MASK ) & heapBLOCK_SIZE_MASK;
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+
+			pxBlock = prvFindFreeBlock( xWantedSize );
+
+			if( pxBlock != NULL )
+			{
+				prvRemoveFreeBlock( pxBlock );
+
+				/* If the block is larger than required it can be split
+				into two, the tail going back to the free lists. */
+				if( ( prvBlockSize( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					pxNewBlock = ( xTlsfBlock * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+					pxNewBlock->xSize = ( prvBlockSize( pxBlock ) - xWantedSize ) | heapBLOCK_FREE_BIT;
+					pxNewBlock->pxPrevPhysBlock = pxBlock;
+					prvNextPhysBlock( pxNewBlock )->pxPrevPhysBlock = pxNewBlock;
+					pxBlock->xSize = xWantedSize;
+					prvInsertFreeBlock( pxNewBlock );
+				}
+
+				/* The block is being returned - it is allocated and owned
+				by the application. */
+				pxBlock->xSize &= ~heapBLOCK_FREE_BIT;
+				xFreeBytesRemaining -= prvBlockSize( pxBlock );
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				xNumberOfSuccessfulAllocations++;
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapBLOCK_OVERHEAD );
+				xWantedSize = prvBlockSize( pxBlock );
+			}
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+xTlsfBlock *pxBlock, *pxNeighbour;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a block header immediately before
+		it. */
+		pxBlock = ( xTlsfBlock * ) ( ( ( unsigned char * ) pv ) - heapBLOCK_OVERHEAD );
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxBlock->xSize & heapBLOCK_FREE_BIT ) == 0 );
+
+		if( ( pxBlock->xSize & heapBLOCK_FREE_BIT ) == 0 )
+		{
+			vTaskSuspendAll();
+			{
+				traceFREE( pv, prvBlockSize( pxBlock ) );
+				xFreeBytesRemaining += prvBlockSize( pxBlock );
+				xNumberOfSuccessfulFrees++;
+
+				/* Merge with the block below if that one is free. */
+				pxNeighbour = pxBlock->pxPrevPhysBlock;
+				if( ( pxNeighbour != NULL ) && ( ( pxNeighbour->xSize & heapBLOCK_FREE_BIT ) != 0 ) )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxNeighbour->xSize += prvBlockSize( pxBlock );
+					pxBlock = pxNeighbour;
+				}
+
+				/* And with the block above.  The end of the heap is marked by
+				a zero sized block that is never free. */
+				pxNeighbour = prvNextPhysBlock( pxBlock );
+				if( ( pxNeighbour->xSize & heapBLOCK_FREE_BIT ) != 0 )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxBlock->xSize += prvBlockSize( pxNeighbour );
+				}
+
+				pxBlock->xSize |= heapBLOCK_FREE_BIT;
+				prvNextPhysBlock( pxBlock )->pxPrevPhysBlock = pxBlock;
+				prvInsertFreeBlock( pxBlock );
+			}
+			xTaskResumeAll();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	prvHeapInitIfNeeded();
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	prvHeapInitIfNeeded();
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+xTlsfBlock *pxBlock;
+size_t xSize;
+unsigned portBASE_TYPE uxFl, uxSl, uxBucket;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+	for( uxBucket = 0; uxBucket < portHEAP_HISTOGRAM_BUCKETS; uxBucket++ )
+	{
+		pxHeapStats->xFreeBlockHistogram[ uxBucket ] = 0;
+	}
+
+	vTaskSuspendAll();
+	{
+		/* The free lists do not exist until the heap is laid out. */
+		if( pxControl == NULL )
+		{
+			prvHeapInit();
+		}
+
+		for( uxFl = 0; uxFl < heapFL_INDEX_COUNT; uxFl++ )
+		{
+			for( uxSl = 0; uxSl < heapSL_INDEX_COUNT; uxSl++ )
+			{
+				for( pxBlock = pxControl->pxFreeLists[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+				{
+					xSize = prvBlockSize( pxBlock );
+
+					if( pxHeapStats->xNumberOfFreeBlocks == 0 || xSize < pxHeapStats->xSizeOfSmallestFreeBlockInBytes )
+					{
+						pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xSize;
+					}
+					if( xSize > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+					{
+						pxHeapStats->xSizeOfLargestFreeBlockInBytes = xSize;
+					}
+					pxHeapStats->xNumberOfFreeBlocks++;
+					pxHeapStats->xFreeBlockHistogram[ prvHistogramBucket( xSize ) ]++;
+				}
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xTlsfBlock *pxFirstFreeBlock, *pxEnd;
+unsigned char *pucAlignedHeap, *pucHeapEnd;
+unsigned portBASE_TYPE uxFl, uxSl;
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	pucAlignedHeap = ( unsigned char * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ portBYTE_ALIGNMENT ] ) & ( ( portPOINTER_SIZE_TYPE ) ~portBYTE_ALIGNMENT_MASK ) );
+	pucHeapEnd = ( unsigned char * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ configTOTAL_HEAP_SIZE ] ) & ( ( portPOINTER_SIZE_TYPE ) ~portBYTE_ALIGNMENT_MASK ) );
+
+	/* The control structure goes first. */
+	pxControl = ( xTlsfControl * ) pucAlignedHeap;
+	pxControl->ulFlBitmap = 0UL;
+	for( uxFl = 0; uxFl < heapFL_INDEX_COUNT; uxFl++ )
+	{
+		pxControl->ulSlBitmap[ uxFl ] = 0UL;
+		for( uxSl = 0; uxSl < heapSL_INDEX_COUNT; uxSl++ )
+		{
+			pxControl->pxFreeLists[ uxFl ][ uxSl ] = NULL;
+		}
+	}
+	pucAlignedHeap += ( sizeof( xTlsfControl ) + portBYTE_ALIGNMENT_MASK ) & heapBLOCK_SIZE_MASK;
+
+	/* A zero sized, permanently allocated, block marks the end of the heap
+	so merging never looks past it.  Only its header is used, but it is given
+	room for a whole xTlsfBlock so that it lies within ucHeap. */
+	pxEnd = ( xTlsfBlock * ) ( pucHeapEnd - heapMINIMUM_BLOCK_SIZE );
+	pxEnd->xSize = 0;
+
+	/* To start with there is a single free block that is sized to take up the
+	entire heap space, minus the space taken by the control structure and
+	pxEnd. */
+	pxFirstFreeBlock = ( xTlsfBlock * ) pucAlignedHeap;
+	pxFirstFreeBlock->pxPrevPhysBlock = NULL;
+	pxFirstFreeBlock->xSize = ( ( unsigned char * ) pxEnd - pucAlignedHeap ) | heapBLOCK_FREE_BIT;
+	pxEnd->pxPrevPhysBlock = pxFirstFreeBlock;
+	prvInsertFreeBlock( pxFirstFreeBlock );
+
+	xFreeBytesRemaining = prvBlockSize( pxFirstFreeBlock );
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInitIfNeeded( void )
+{
+	if( pxControl == NULL )
+	{
+		vTaskSuspendAll();
+		{
+			if( pxControl == NULL )
+			{
+				prvHeapInit();
+			}
+		}
+		xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFl, unsigned portBASE_TYPE *puxSl )
+{
+unsigned portBASE_TYPE uxFl;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are spread linearly over the first class. */
+		*puxFl = 0;
+		*puxSl = xSize / ( heapSMALL_BLOCK_SIZE / heapSL_INDEX_COUNT );
+	}
+	else
+	{
+		uxFl = prvFls( xSize );
+		*puxSl = ( xSize >> ( uxFl - heapSL_INDEX_COUNT_LOG2 ) ) ^ ( 1 << heapSL_INDEX_COUNT_LOG2 );
+		*puxFl = uxFl - ( heapFL_INDEX_SHIFT - 1 );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xSize, unsigned portBASE_TYPE *puxFl, unsigned portBASE_TYPE *puxSl )
+{
+	/* Round up to the next list boundary so that every block on the list
+	found is large enough. */
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( prvFls( xSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+
+	prvMappingInsert( xSize, puxFl, puxSl );
+}
+/*-----------------------------------------------------------*/
+
+static xTlsfBlock *prvFindFreeBlock( size_t xSize )
+{
+unsigned portBASE_TYPE uxFl, uxSl;
+unsigned long ulMap = 0UL;
+xTlsfBlock *pxBlock;
+
+	prvMappingSearch( xSize, &uxFl, &uxSl );
+
+	if( uxFl < heapFL_INDEX_COUNT )
+	{
+		/* First look for a non empty list in the same size class, then take
+		the smallest non empty larger class. */
+		ulMap = pxControl->ulSlBitmap[ uxFl ] & ( ~0UL << uxSl );
+		if( ulMap == 0UL )
+		{
+			ulMap = pxControl->ulFlBitmap & ( ~0UL << ( uxFl + 1 ) );
+			if( ulMap != 0UL )
+			{
+				uxFl = prvFfs( ulMap );
+				ulMap = pxControl->ulSlBitmap[ uxFl ];
+			}
+		}
+	}
+
+	if( ulMap != 0UL )
+	{
+		return pxControl->pxFreeLists[ uxFl ][ prvFfs( ulMap ) ];
+	}
+
+	/* The rounding up can skip the only block that fits, typically when
+	asking for most of what is left.  Try the head of the list the request
+	itself maps to - still a constant time check. */
+	prvMappingInsert( xSize, &uxFl, &uxSl );
+	pxBlock = pxControl->pxFreeLists[ uxFl ][ uxSl ];
+	if( ( pxBlock != NULL ) && ( prvBlockSize( pxBlock ) >= xSize ) )
+	{
+		return pxBlock;
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( xTlsfBlock *pxBlock )
+{
+unsigned portBASE_TYPE uxFl, uxSl;
+xTlsfBlock **ppxHead;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+	ppxHead = &( pxControl->pxFreeLists[ uxFl ][ uxSl ] );
+
+	pxBlock->pxPrevFree = NULL;
+	pxBlock->pxNextFree = *ppxHead;
+	if( *ppxHead != NULL )
+	{
+		( *ppxHead )->pxPrevFree = pxBlock;
+	}
+	*ppxHead = pxBlock;
+
+	pxControl->ulFlBitmap |= 1UL << uxFl;
+	pxControl->ulSlBitmap[ uxFl ] |= 1UL << uxSl;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( xTlsfBlock *pxBlock )
+{
+unsigned portBASE_TYPE uxFl, uxSl;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		/* The block was the head of its list, clear the bitmaps if the list
+		is now empty. */
+		pxControl->pxFreeLists[ uxFl ][ uxSl ] = pxBlock->pxNextFree;
+		if( pxBlock->pxNextFree == NULL )
+		{
+			pxControl->ulSlBitmap[ uxFl ] &= ~( 1UL << uxSl );
+			if( pxControl->ulSlBitmap[ uxFl ] == 0UL )
+			{
+				pxControl->ulFlBitmap &= ~( 1UL << uxFl );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize )
+{
+unsigned portBASE_TYPE uxBucket = 0;
+
+	while( ( uxBucket < ( portHEAP_HISTOGRAM_BUCKETS - 1 ) ) && ( xBlockSize >= ( ( size_t ) 32 << uxBucket ) ) )
+	{
+		uxBucket++;
+	}
+
+	return uxBucket;
+}
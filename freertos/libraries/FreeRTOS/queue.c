@@ -79,6 +79,10 @@ task.h is included from an application file. */
 	#include "croutine.h"
 #endif
 
+#if ( configQUEUE_POOL_SIZE > 0 )
+	#include "mempool.h"
+#endif
+
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
 /*-----------------------------------------------------------
@@ -141,7 +145,18 @@ typedef struct QueueDefinition
 		unsigned char ucQueueType;
 	#endif
 
+	unsigned char ucStaticallyAllocated;	/*< queueSTATIC_QUEUE and queueSTATIC_STORAGE for the parts vQueueDelete() must not free. */
+
 } xQUEUE;
+
+/* Values for the ucStaticallyAllocated member of xQUEUE. */
+#define queueSTATIC_QUEUE				( ( unsigned char ) 0x01U )
+#define queueSTATIC_STORAGE				( ( unsigned char ) 0x02U )
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* xStaticQueueType must be able to hold a queue. */
+	typedef char xStaticQueueMatchesQueue[ ( sizeof( xStaticQueueType ) == sizeof( xQUEUE ) ) ? 1 : -1 ];
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -151,6 +166,22 @@ typedef struct QueueDefinition
  */
 typedef xQUEUE * xQueueHandle;
 
+/*
+ * Queue control blocks come from a block pool when configQUEUE_POOL_SIZE asks
+ * for it, from the heap otherwise.  The storage area is sized per queue and
+ * always comes from the heap.
+ */
+#if ( configQUEUE_POOL_SIZE > 0 )
+	static unsigned char ucQueuePoolStorage[ memPOOL_STORAGE_SIZE( sizeof( xQUEUE ), configQUEUE_POOL_SIZE ) ] memPOOL_ALIGNED;
+	static xMemPool xQueuePool = memPOOL_INITIALISER( ucQueuePoolStorage, sizeof( xQUEUE ), configQUEUE_POOL_SIZE );
+
+	#define queueALLOCATE_QUEUE()			( xQUEUE * ) pvMemPoolTakeOrMalloc( &xQueuePool, sizeof( xQUEUE ) )
+	#define queueFREE_QUEUE( pxQueue )		vMemPoolGiveOrFree( &xQueuePool, ( pxQueue ) )
+#else
+	#define queueALLOCATE_QUEUE()			( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) )
+	#define queueFREE_QUEUE( pxQueue )		vPortFree( ( pxQueue ) )
+#endif
+
 /*
  * Prototypes for public functions are included here so we don't have to
  * include the API header file (as it defines xQueueHandle differently).  These
@@ -179,6 +210,11 @@ unsigned char ucQueueGetQueueType( xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue ) PRIVILEGED_FUNCTION;
 xTaskHandle xQueueGetMutexHolder( xQueueHandle xSemaphore ) PRIVILEGED_FUNCTION;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueueType *pxStaticQueue ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Co-routine queue functions differ from task queue functions.  Co-routines are
  * an optional component.
@@ -250,6 +286,15 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
  * Copies an item out of a queue.
  */
 static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sets up a queue, or a mutex, in memory that has already been found for its
+ * structure and storage area.
+ */
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+#if ( configUSE_MUTEXES == 1 )
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -328,7 +373,7 @@ xQueueHandle xReturn = NULL;
 	/* Allocate the new queue structure. */
 	if( uxQueueLength > ( unsigned portBASE_TYPE ) 0 )
 	{
-		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
+		pxNewQueue = queueALLOCATE_QUEUE();
 		if( pxNewQueue != NULL )
 		{
 			/* Create the list of pointers to queue items.  The queue is one byte
@@ -338,24 +383,14 @@ xQueueHandle xReturn = NULL;
 			pxNewQueue->pcHead = ( signed char * ) pvPortMalloc( xQueueSizeInBytes );
 			if( pxNewQueue->pcHead != NULL )
 			{
-				/* Initialise the queue members as described above where the
-				queue type is defined. */
-				pxNewQueue->uxLength = uxQueueLength;
-				pxNewQueue->uxItemSize = uxItemSize;
-				xQueueGenericReset( pxNewQueue, pdTRUE );
-				#if ( configUSE_TRACE_FACILITY == 1 )
-				{
-					pxNewQueue->ucQueueType = ucQueueType;
-				}
-				#endif /* configUSE_TRACE_FACILITY */
-
-				traceQUEUE_CREATE( pxNewQueue );
+				pxNewQueue->ucStaticallyAllocated = 0U;
+				prvInitialiseNewQueue( pxNewQueue, uxQueueLength, uxItemSize, ucQueueType );
 				xReturn = pxNewQueue;
 			}
 			else
 			{
 				traceQUEUE_CREATE_FAILED( ucQueueType );
-				vPortFree( pxNewQueue );
+				queueFREE_QUEUE( pxNewQueue );
 			}
 		}
 	}
@@ -366,62 +401,160 @@ xQueueHandle xReturn = NULL;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue, unsigned char ucQueueType )
+	{
+	xQUEUE *pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+
+		configASSERT( pxStaticQueue );
+		configASSERT( uxQueueLength > ( unsigned portBASE_TYPE ) 0 );
+
+		/* Items of size zero need no storage, anything else needs an area of
+		uxQueueLength * uxItemSize bytes. */
+		configASSERT( ( pucQueueStorage != NULL ) == ( uxItemSize != ( unsigned portBASE_TYPE ) 0 ) );
+
+		if( ( pxNewQueue != NULL ) && ( uxQueueLength > ( unsigned portBASE_TYPE ) 0 ) )
+		{
+			pxNewQueue->ucStaticallyAllocated = queueSTATIC_QUEUE | queueSTATIC_STORAGE;
+
+			/* A semaphore never copies anything, but pcHead must not be NULL
+			as that would mark the queue as a mutex. */
+			if( pucQueueStorage != NULL )
+			{
+				pxNewQueue->pcHead = ( signed char * ) pucQueueStorage;
+			}
+			else
+			{
+				pxNewQueue->pcHead = ( signed char * ) pxNewQueue;
+			}
+
+			prvInitialiseNewQueue( pxNewQueue, uxQueueLength, uxItemSize, ucQueueType );
+		}
+		else
+		{
+			traceQUEUE_CREATE_FAILED( ucQueueType );
+			pxNewQueue = NULL;
+		}
+
+		return pxNewQueue;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType )
+{
+	/* Remove compiler warnings about unused parameters should
+	configUSE_TRACE_FACILITY not be set to 1. */
+	( void ) ucQueueType;
+
+	/* Initialise the queue members as described above where the
+	queue type is defined. */
+	pxNewQueue->uxLength = uxQueueLength;
+	pxNewQueue->uxItemSize = uxItemSize;
+	xQueueGenericReset( pxNewQueue, pdTRUE );
+	#if ( configUSE_TRACE_FACILITY == 1 )
+	{
+		pxNewQueue->ucQueueType = ucQueueType;
+	}
+	#endif /* configUSE_TRACE_FACILITY */
+
+	traceQUEUE_CREATE( pxNewQueue );
+}
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_MUTEXES == 1 )
 
 	xQueueHandle xQueueCreateMutex( unsigned char ucQueueType )
 	{
 	xQUEUE *pxNewQueue;
 
-		/* Prevent compiler warnings about unused parameters if
-		configUSE_TRACE_FACILITY does not equal 1. */
-		( void ) ucQueueType;
-
 		/* Allocate the new queue structure. */
-		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
+		pxNewQueue = queueALLOCATE_QUEUE();
 		if( pxNewQueue != NULL )
 		{
-			/* Information required for priority inheritance. */
-			pxNewQueue->pxMutexHolder = NULL;
-			pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
-
-			/* Queues used as a mutex no data is actually copied into or out
-			of the queue. */
-			pxNewQueue->pcWriteTo = NULL;
-			pxNewQueue->pcReadFrom = NULL;
-
-			/* Each mutex has a length of 1 (like a binary semaphore) and
-			an item size of 0 as nothing is actually copied into or out
-			of the mutex. */
-			pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
-			pxNewQueue->uxLength = ( unsigned portBASE_TYPE ) 1U;
-			pxNewQueue->uxItemSize = ( unsigned portBASE_TYPE ) 0U;
-			pxNewQueue->xRxLock = queueUNLOCKED;
-			pxNewQueue->xTxLock = queueUNLOCKED;
-
-			#if ( configUSE_TRACE_FACILITY == 1 )
-			{
-				pxNewQueue->ucQueueType = ucQueueType;
-			}
-			#endif
+			pxNewQueue->ucStaticallyAllocated = 0U;
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
+		}
+		else
+		{
+			traceCREATE_MUTEX_FAILED();
+		}
+
+		configASSERT( pxNewQueue );
+		return pxNewQueue;
+	}
 
-			/* Ensure the event queues start with the correct state. */
-			vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
-			vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_MUTEXES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
 
-			traceCREATE_MUTEX( pxNewQueue );
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueueType *pxStaticQueue )
+	{
+	xQUEUE *pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+
+		configASSERT( pxStaticQueue );
 
-			/* Start with the semaphore in the expected state. */
-			xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
+		if( pxNewQueue != NULL )
+		{
+			pxNewQueue->ucStaticallyAllocated = queueSTATIC_QUEUE | queueSTATIC_STORAGE;
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
 		}
 		else
 		{
 			traceCREATE_MUTEX_FAILED();
 		}
 
-		configASSERT( pxNewQueue );
 		return pxNewQueue;
 	}
 
+#endif /* configUSE_MUTEXES && configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType )
+	{
+		/* Prevent compiler warnings about unused parameters if
+		configUSE_TRACE_FACILITY does not equal 1. */
+		( void ) ucQueueType;
+
+		/* Information required for priority inheritance. */
+		pxNewQueue->pxMutexHolder = NULL;
+		pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
+
+		/* Queues used as a mutex no data is actually copied into or out
+		of the queue. */
+		pxNewQueue->pcWriteTo = NULL;
+		pxNewQueue->pcReadFrom = NULL;
+
+		/* Each mutex has a length of 1 (like a binary semaphore) and
+		an item size of 0 as nothing is actually copied into or out
+		of the mutex. */
+		pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
+		pxNewQueue->uxLength = ( unsigned portBASE_TYPE ) 1U;
+		pxNewQueue->uxItemSize = ( unsigned portBASE_TYPE ) 0U;
+		pxNewQueue->xRxLock = queueUNLOCKED;
+		pxNewQueue->xTxLock = queueUNLOCKED;
+
+		#if ( configUSE_TRACE_FACILITY == 1 )
+		{
+			pxNewQueue->ucQueueType = ucQueueType;
+		}
+		#endif
+
+		/* Ensure the event queues start with the correct state. */
+		vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
+		vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+
+		traceCREATE_MUTEX( pxNewQueue );
+
+		/* Start with the semaphore in the expected state. */
+		xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
+	}
+
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
@@ -1189,8 +1322,16 @@ void vQueueDelete( xQueueHandle pxQueue )
 
 	traceQUEUE_DELETE( pxQueue );
 	vQueueUnregisterQueue( pxQueue );
-	vPortFree( pxQueue->pcHead );
-	vPortFree( pxQueue );
+
+	/* Memory supplied by the application stays with the application. */
+	if( ( pxQueue->ucStaticallyAllocated & queueSTATIC_STORAGE ) == 0U )
+	{
+		vPortFree( pxQueue->pcHead );
+	}
+	if( ( pxQueue->ucStaticallyAllocated & queueSTATIC_QUEUE ) == 0U )
+	{
+		queueFREE_QUEUE( pxQueue );
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -79,6 +79,10 @@ task.h is included from an application file. */
 #include "timers.h"
 #include "StackMacros.h"
 
+#if ( configTCB_POOL_SIZE > 0 ) || ( configSTACK_POOL_SIZE > 0 )
+	#include "mempool.h"
+#endif
+
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
 /*
@@ -86,6 +90,14 @@ task.h is included from an application file. */
  */
 #define tskIDLE_STACK_SIZE	configMINIMAL_STACK_SIZE
 
+/* Values that can be assigned to the eNotifyState member of the TCB. */
+typedef enum
+{
+	eNotWaitingNotification = 0,
+	eWaitingNotification,
+	eNotified
+} eNotifyValue;
+
 /*
  * Task control block.  A task control block (TCB) is allocated to each task,
  * and stores the context of the task.
@@ -127,10 +139,53 @@ typedef struct tskTaskControlBlock
 
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
+		unsigned long ulSwitchCount;		/*< The number of times the task has been switched in. */
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;		/*< The value sent by xTaskNotify() and friends. */
+		volatile eNotifyValue eNotifyState;			/*< Whether the task is waiting for, or has a pending, notification. */
+	#endif
+
+	unsigned char ucStaticallyAllocated;	/*< tskSTATIC_TCB and tskSTATIC_STACK for the parts the kernel must not free. */
+
 } tskTCB;
 
+/* Values for the ucStaticallyAllocated member of the TCB. */
+#define tskSTATIC_TCB		( ( unsigned char ) 0x01U )
+#define tskSTATIC_STACK		( ( unsigned char ) 0x02U )
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* xStaticTaskType must be able to hold a TCB. */
+	typedef char xStaticTaskMatchesTCB[ ( sizeof( xStaticTaskType ) == sizeof( tskTCB ) ) ? 1 : -1 ];
+#endif
+
+/*
+ * TCBs and stacks come from block pools when configTCB_POOL_SIZE or
+ * configSTACK_POOL_SIZE ask for it, from the heap otherwise.
+ */
+#if ( configTCB_POOL_SIZE > 0 )
+	PRIVILEGED_DATA static unsigned char ucTCBPoolStorage[ memPOOL_STORAGE_SIZE( sizeof( tskTCB ), configTCB_POOL_SIZE ) ] memPOOL_ALIGNED;
+	PRIVILEGED_DATA static xMemPool xTCBPool = memPOOL_INITIALISER( ucTCBPoolStorage, sizeof( tskTCB ), configTCB_POOL_SIZE );
+
+	#define taskALLOCATE_TCB()				( tskTCB * ) pvMemPoolTakeOrMalloc( &xTCBPool, sizeof( tskTCB ) )
+	#define taskFREE_TCB( pxTCB )			vMemPoolGiveOrFree( &xTCBPool, ( pxTCB ) )
+#else
+	#define taskALLOCATE_TCB()				( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) )
+	#define taskFREE_TCB( pxTCB )			vPortFree( ( pxTCB ) )
+#endif
+
+#if ( configSTACK_POOL_SIZE > 0 )
+	PRIVILEGED_DATA static unsigned char ucStackPoolStorage[ memPOOL_STORAGE_SIZE( configSTACK_POOL_DEPTH * sizeof( portSTACK_TYPE ), configSTACK_POOL_SIZE ) ] memPOOL_ALIGNED;
+	PRIVILEGED_DATA static xMemPool xStackPool = memPOOL_INITIALISER( ucStackPoolStorage, configSTACK_POOL_DEPTH * sizeof( portSTACK_TYPE ), configSTACK_POOL_SIZE );
+
+	#define taskALLOCATE_STACK( xSize, puxStackBuffer )	( ( ( puxStackBuffer ) == NULL ) ? pvMemPoolTakeOrMalloc( &xStackPool, ( xSize ) ) : ( void * ) ( puxStackBuffer ) )
+	#define taskFREE_STACK( pxStack )					vMemPoolGiveOrFree( &xStackPool, ( pxStack ) )
+#else
+	#define taskALLOCATE_STACK( xSize, puxStackBuffer )	pvPortMallocAligned( ( xSize ), ( puxStackBuffer ) )
+	#define taskFREE_STACK( pxStack )					vPortFreeAligned( ( pxStack ) )
+#endif
+
 
 /*
  * Some kernel aware debuggers require data to be viewed to be global, rather
@@ -210,6 +265,69 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+
+	/* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 0 then task selection is
+	performed in a generic way that is not optimised to any particular
+	microcontroller architecture.  uxTopReadyPriority holds the priority of the
+	highest priority ready state task. */
+	#define taskRECORD_READY_PRIORITY( uxPriority )														\
+	{																									\
+		if( ( uxPriority ) > uxTopReadyPriority )														\
+		{																								\
+			uxTopReadyPriority = ( uxPriority );														\
+		}																								\
+	}
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()															\
+	{																									\
+		/* Find the highest priority queue that contains ready tasks. */								\
+		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )						\
+		{																								\
+			configASSERT( uxTopReadyPriority );															\
+			--uxTopReadyPriority;																		\
+		}																								\
+																										\
+		/* listGET_OWNER_OF_NEXT_ENTRY indexes through the list, so the tasks of						\
+		the same priority get an equal share of the processor time. */									\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );		\
+	}
+
+	/* The generic search walks down from uxTopReadyPriority on its own, so
+	nothing needs resetting when a ready list becomes empty. */
+	#define taskRESET_READY_PRIORITY( uxPriority )
+
+#else
+
+	/* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 1 then task selection is
+	performed in a way that is tailored to the particular microcontroller
+	architecture being used.  uxTopReadyPriority is then a bitmap with one bit
+	set for each priority that has a non-empty ready list. */
+	#define taskRECORD_READY_PRIORITY( uxPriority )	portRECORD_READY_PRIORITY( uxPriority, uxTopReadyPriority )
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()														\
+	{																								\
+	unsigned portBASE_TYPE uxTopPriority;															\
+																									\
+		/* Find the highest priority queue that contains ready tasks. */							\
+		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );								\
+		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );		\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );		\
+	}
+
+	/* A task has been removed from the list it was in.  If that was the ready
+	list of its priority and the list is now empty, clear the priority's bit. */
+	#define taskRESET_READY_PRIORITY( uxPriority )														\
+	{																									\
+		if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == 0 )					\
+		{																								\
+			portRESET_READY_PRIORITY( ( uxPriority ), ( uxTopReadyPriority ) );						\
+		}																								\
+	}
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready queue for
  * the task.  It is inserted at the end of the list.  One quirk of this is
@@ -219,10 +337,7 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
  */
 #define prvAddTaskToReadyQueue( pxTCB )																					\
 	traceMOVED_TASK_TO_READY_STATE( pxTCB )																				\
-	if( ( pxTCB )->uxPriority > uxTopReadyPriority )																	\
-	{																													\
-		uxTopReadyPriority = ( pxTCB )->uxPriority;																		\
-	}																													\
+	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );																	\
 	vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) )
 /*-----------------------------------------------------------*/
 
@@ -352,11 +467,56 @@ static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
  */
 static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake ) PRIVILEGED_FUNCTION;
 
+/*
+ * Return the amount of time, in ticks, that will pass before the kernel will
+ * next move a task from the Blocked state to the Running state, or zero if
+ * a task other than the idle task is able to run.
+ *
+ * This conditional compilation should use inequality to 0, not equality to 1.
+ * This is to ensure portSUPPRESS_TICKS_AND_SLEEP() can be called when user
+ * defined low power mode implementations require configUSE_TICKLESS_IDLE to be
+ * set to a value other than 1.
+ */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Move the currently executing task out of its ready list and block it for
+ * up to xTicksToWait ticks without placing it on any event list.  Used by the
+ * task notification functions, where the TCB itself is the event object.
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvAddCurrentTaskToBlockedState( portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Make a task that was blocked waiting for a notification ready to run, from
+ * within an interrupt.  If the scheduler is suspended the task is held on the
+ * pending ready list until xTaskResumeAll() moves it.
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvUnblockNotifiedTaskFromISR( tskTCB *pxTCB, portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Allocates memory from the heap for a TCB and associated stack.  Checks the
- * allocation was successful.
+ * allocation was successful.  Either may be supplied by the caller instead,
+ * in which case it is used as is.
+ */
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Creates a task in the memory prvAllocateTCBAndStack() provides, on behalf of
+ * xTaskGenericCreate() and xTaskCreateStatic().
  */
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
+static signed portBASE_TYPE prvTaskCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer, const xMemoryRegion * const xRegions ) PRIVILEGED_FUNCTION;
 
 /*
  * Called from vTaskList.  vListTasks details all the tasks currently under
@@ -373,6 +533,17 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
 
 #endif
 
+/*
+ * Called from uxTaskGetSystemState().  Fills an xTaskStatusType structure
+ * for each task in pxList, all of which are in state eState, and returns the
+ * number of structures written.
+ */
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	static unsigned portBASE_TYPE prvListTaskStatusWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList, eTaskState eState ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * When a task is created, the stack of the task is filled with a known value.
  * This function determines the 'high water mark' of the task stack by
@@ -394,6 +565,32 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  *----------------------------------------------------------*/
 
 signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+{
+	return prvTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, NULL, xRegions );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTaskHandle xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer )
+	{
+	xTaskHandle xCreatedTask = NULL;
+
+		configASSERT( puxStackBuffer );
+		configASSERT( pxTaskBuffer );
+
+		if( ( puxStackBuffer != NULL ) && ( pxTaskBuffer != NULL ) )
+		{
+			prvTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, &xCreatedTask, puxStackBuffer, ( tskTCB * ) pxTaskBuffer, NULL );
+		}
+
+		return xCreatedTask;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static signed portBASE_TYPE prvTaskCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer, const xMemoryRegion * const xRegions )
 {
 signed portBASE_TYPE xReturn;
 tskTCB * pxNewTCB;
@@ -403,7 +600,7 @@ tskTCB * pxNewTCB;
 
 	/* Allocate the memory required by the TCB and stack for the new task,
 	checking that the allocation was successful. */
-	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer );
+	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer, pxTCBBuffer );
 
 	if( pxNewTCB != NULL )
 	{
@@ -579,6 +776,7 @@ tskTCB * pxNewTCB;
 			the termination list and free up any memory allocated by the
 			scheduler for the TCB and stack. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -671,6 +869,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 		}
@@ -717,6 +916,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 			xAlreadyYielded = xTaskResumeAll();
@@ -848,6 +1048,7 @@ tskTCB * pxNewTCB;
 					it to it's new ready list.  As we are in a critical section we
 					can do this even if the scheduler is suspended. */
 					vListRemove( &( pxTCB->xGenericListItem ) );
+					taskRESET_READY_PRIORITY( uxCurrentPriority );
 					prvAddTaskToReadyQueue( pxTCB );
 				}
 
@@ -885,6 +1086,7 @@ tskTCB * pxNewTCB;
 
 			/* Remove task from the ready/delayed list and place in the	suspended list. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -1339,6 +1541,76 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 #endif
 /*----------------------------------------------------------*/
 
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime )
+	{
+	unsigned portBASE_TYPE uxTask = 0, uxQueue = configMAX_PRIORITIES;
+
+		vTaskSuspendAll();
+		{
+			/* Is there a space in the array for each task in the system? */
+			if( uxArraySize >= uxCurrentNumberOfTasks )
+			{
+				/* Fill in an xTaskStatusType structure with information on
+				each task in the Ready state. */
+				do
+				{
+					uxQueue--;
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), eReady );
+
+				} while( uxQueue > ( unsigned portBASE_TYPE ) tskIDLE_PRIORITY );
+
+				/* Fill in an xTaskStatusType structure with information on
+				each task in the Blocked state. */
+				uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxDelayedTaskList, eBlocked );
+				uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxOverflowDelayedTaskList, eBlocked );
+
+				#if( INCLUDE_vTaskDelete == 1 )
+				{
+					/* Fill in an xTaskStatusType structure with information on
+					each task that has been deleted but not yet cleaned up. */
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xTasksWaitingTermination, eDeleted );
+				}
+				#endif
+
+				#if ( INCLUDE_vTaskSuspend == 1 )
+				{
+					/* Fill in an xTaskStatusType structure with information on
+					each task in the Suspended state. */
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xSuspendedTaskList, eSuspended );
+				}
+				#endif
+
+				#if ( configGENERATE_RUN_TIME_STATS == 1 )
+				{
+					if( pulTotalRunTime != NULL )
+					{
+						#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+							portALT_GET_RUN_TIME_COUNTER_VALUE( ( *pulTotalRunTime ) );
+						#else
+							*pulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
+						#endif
+					}
+				}
+				#else
+				{
+					if( pulTotalRunTime != NULL )
+					{
+						*pulTotalRunTime = 0;
+					}
+				}
+				#endif
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return uxTask;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
 	void vTaskGetRunTimeStats( signed char *pcWriteBuffer )
@@ -1628,16 +1900,22 @@ void vTaskSwitchContext( void )
 		taskFIRST_CHECK_FOR_STACK_OVERFLOW();
 		taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 	
-		/* Find the highest priority queue that contains ready tasks. */
-		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		{
-			configASSERT( uxTopReadyPriority );
-			--uxTopReadyPriority;
+		tskTCB *pxPreviousTCB = pxCurrentTCB;
+
+			taskSELECT_HIGHEST_PRIORITY_TASK();
+
+			if( pxCurrentTCB != pxPreviousTCB )
+			{
+				( pxCurrentTCB->ulSwitchCount )++;
+			}
 		}
-	
-		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
-		same priority get an equal share of the processor time. */
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );
+		#else
+		{
+			taskSELECT_HIGHEST_PRIORITY_TASK();
+		}
+		#endif
 	
 		traceTASK_SWITCHED_IN();
 	}
@@ -1662,6 +1940,7 @@ portTickType xTimeToWake;
 	to the blocked list as the same list item is used for both lists.  We have
 	exclusive access to the ready lists as the scheduler is locked. */
 	vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 
 	#if ( INCLUDE_vTaskSuspend == 1 )
@@ -1716,6 +1995,7 @@ portTickType xTimeToWake;
 		blocked list as the same list item is used for both lists.  This
 		function is called form a critical section. */
 		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 		/* Calculate the time at which the task should be woken if the event does
 		not occur.  This may overflow but this doesn't matter. */
@@ -1921,6 +2201,35 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 		}
 		#endif
 
+		#if ( configUSE_TICKLESS_IDLE != 0 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* It is not desirable to suspend then resume the scheduler on
+			each iteration of the idle task.  Therefore, a preliminary test of
+			the expected idle time is performed without the scheduler
+			suspended.  The result here is not necessarily valid. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					/* Now the scheduler is suspended, the expected idle
+					time can be sampled again, and this time its value can
+					be used. */
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+					}
+				}
+				xTaskResumeAll();
+			}
+		}
+		#endif
+
 		#if ( configUSE_IDLE_HOOK == 1 )
 		{
 			extern void vApplicationIdleHook( void );
@@ -1942,6 +2251,45 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 
 
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	eSleepModeStatus eTaskConfirmSleepModeStatus( void )
+	{
+	eSleepModeStatus eReturn = eStandardSleep;
+
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != 0 )
+		{
+			/* A task was made ready while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( xMissedYield != pdFALSE )
+		{
+			/* A yield was pended while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+
+		return eReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* Correct the tick count value after a period during which the tick
+		was suppressed.  Note this does *not* call the tick hook function for
+		each stepped tick.  The scheduler is still suspended, so ticks that
+		arrived during the sleep are counted in uxMissedTicks and have to be
+		included in the check. */
+		configASSERT( ( xTickCount + uxMissedTicks + xTicksToJump ) <= xNextTaskUnblockTime );
+		xTickCount += xTicksToJump;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 /*-----------------------------------------------------------
  * File private functions documented at the top of the file.
  *----------------------------------------------------------*/
@@ -1999,6 +2347,14 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
 		pxTCB->ulRunTimeCounter = 0UL;
+		pxTCB->ulSwitchCount = 0UL;
+	}
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->eNotifyState = eNotWaitingNotification;
 	}
 	#endif
 
@@ -2101,6 +2457,42 @@ static void prvCheckTasksWaitingTermination( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+
+		if( pxCurrentTCB->uxPriority > tskIDLE_PRIORITY )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > 1 )
+		{
+			/* There are other idle priority tasks in the ready state.  If
+			time slicing is used then the very next tick interrupt must be
+			processed. */
+			xReturn = 0;
+		}
+		else if( xNextTaskUnblockTime > xTickCount )
+		{
+			/* When nothing is delayed in the current list xNextTaskUnblockTime
+			is portMAX_DELAY, so the sleep never steps over a tick count
+			overflow and the delayed lists are still swapped by a real
+			tick. */
+			xReturn = xNextTaskUnblockTime - xTickCount;
+		}
+		else
+		{
+			xReturn = 0;
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 {
 	/* The list item will be inserted in wake time order. */
@@ -2127,29 +2519,50 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 }
 /*-----------------------------------------------------------*/
 
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer )
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer )
 {
 tskTCB *pxNewTCB;
 
 	/* Allocate space for the TCB.  Where the memory comes from depends on
 	the implementation of the port malloc function. */
-	pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+	if( pxTCBBuffer != NULL )
+	{
+		pxNewTCB = pxTCBBuffer;
+	}
+	else
+	{
+		pxNewTCB = taskALLOCATE_TCB();
+	}
 
 	if( pxNewTCB != NULL )
 	{
 		/* Allocate space for the stack used by the task being created.
 		The base of the stack memory stored in the TCB so the task can
 		be deleted later if required. */
-		pxNewTCB->pxStack = ( portSTACK_TYPE * ) pvPortMallocAligned( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
+		pxNewTCB->pxStack = ( portSTACK_TYPE * ) taskALLOCATE_STACK( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
 
 		if( pxNewTCB->pxStack == NULL )
 		{
 			/* Could not allocate the stack.  Delete the allocated TCB. */
-			vPortFree( pxNewTCB );
+			if( pxTCBBuffer == NULL )
+			{
+				taskFREE_TCB( pxNewTCB );
+			}
 			pxNewTCB = NULL;
 		}
 		else
 		{
+			/* Remember what prvDeleteTCB() must leave alone. */
+			pxNewTCB->ucStaticallyAllocated = 0U;
+			if( pxTCBBuffer != NULL )
+			{
+				pxNewTCB->ucStaticallyAllocated |= tskSTATIC_TCB;
+			}
+			if( puxStackBuffer != NULL )
+			{
+				pxNewTCB->ucStaticallyAllocated |= tskSTATIC_STACK;
+			}
+
 			/* Just to help debugging. */
 			memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) usStackDepth * sizeof( portSTACK_TYPE ) );
 		}
@@ -2191,6 +2604,81 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	static unsigned portBASE_TYPE prvListTaskStatusWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList, eTaskState eState )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+	unsigned portBASE_TYPE uxTask = 0;
+
+		if( listCURRENT_LIST_LENGTH( pxList ) > ( unsigned portBASE_TYPE ) 0 )
+		{
+			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+
+			/* Populate an xTaskStatusType structure within the
+			pxTaskStatusArray array for each task that is referenced from
+			pxList.  See the definition of xTaskStatusType in task.h for the
+			meaning of each structure member. */
+			do
+			{
+				listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+				pxTaskStatusArray[ uxTask ].xHandle = ( xTaskHandle ) pxNextTCB;
+				pxTaskStatusArray[ uxTask ].pcTaskName = ( const signed char * ) &( pxNextTCB->pcTaskName [ 0 ] );
+				pxTaskStatusArray[ uxTask ].xTaskNumber = pxNextTCB->uxTCBNumber;
+				pxTaskStatusArray[ uxTask ].eCurrentState = ( pxNextTCB == pxCurrentTCB ) ? eRunning : eState;
+				pxTaskStatusArray[ uxTask ].uxCurrentPriority = pxNextTCB->uxPriority;
+
+				/* A task blocked with an infinite timeout sits in the
+				suspended list. */
+				if( ( eState == eSuspended ) && ( pxNextTCB->xEventListItem.pvContainer != NULL ) )
+				{
+					pxTaskStatusArray[ uxTask ].eCurrentState = eBlocked;
+				}
+
+				#if ( configUSE_MUTEXES == 1 )
+				{
+					pxTaskStatusArray[ uxTask ].uxBasePriority = pxNextTCB->uxBasePriority;
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].uxBasePriority = 0;
+				}
+				#endif
+
+				#if ( configGENERATE_RUN_TIME_STATS == 1 )
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = pxNextTCB->ulRunTimeCounter;
+					pxTaskStatusArray[ uxTask ].ulSwitchCount = pxNextTCB->ulSwitchCount;
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = 0;
+					pxTaskStatusArray[ uxTask ].ulSwitchCount = 0;
+				}
+				#endif
+
+				#if ( portSTACK_GROWTH > 0 )
+				{
+					pxTaskStatusArray[ uxTask ].usStackHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxEndOfStack );
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].usStackHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxStack );
+				}
+				#endif
+
+				uxTask++;
+
+			} while( pxNextTCB != pxFirstTCB );
+		}
+
+		return uxTask;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
 	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime )
@@ -2320,9 +2808,16 @@ tskTCB *pxNewTCB;
 		portCLEAN_UP_TCB( pxTCB );
 
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
-		the task to free any memory allocated at the application level. */
-		vPortFreeAligned( pxTCB->pxStack );
-		vPortFree( pxTCB );
+		the task to free any memory allocated at the application level, and
+		to reuse any it supplied when the task was created. */
+		if( ( pxTCB->ucStaticallyAllocated & tskSTATIC_STACK ) == 0U )
+		{
+			taskFREE_STACK( pxTCB->pxStack );
+		}
+		if( ( pxTCB->ucStaticallyAllocated & tskSTATIC_TCB ) == 0U )
+		{
+			taskFREE_TCB( pxTCB );
+		}
 	}
 
 #endif
@@ -2394,6 +2889,7 @@ tskTCB *pxNewTCB;
 			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) ) != pdFALSE )
 			{
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Inherit the priority before being moved into the new list. */
 				pxTCB->uxPriority = pxCurrentTCB->uxPriority;
@@ -2425,6 +2921,7 @@ tskTCB *pxNewTCB;
 				/* We must be the running task to be able to give the mutex back.
 				Remove ourselves from the ready list we currently appear in. */
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Disinherit the priority before adding the task into the new
 				ready list. */
@@ -2475,6 +2972,335 @@ void vTaskExitCritical( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvAddCurrentTaskToBlockedState( portTickType xTicksToWait )
+	{
+		/* THIS FUNCTION MUST BE CALLED FROM A CRITICAL SECTION. */
+
+		/* The same list item is used for the ready and blocked lists. */
+		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+
+		#if ( INCLUDE_vTaskSuspend == 1 )
+		{
+			if( xTicksToWait == portMAX_DELAY )
+			{
+				/* Block indefinitely, without being woken by a timing event. */
+				vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+			else
+			{
+				prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+			}
+		}
+		#else
+		{
+			prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+		}
+		#endif
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 
+	static void prvUnblockNotifiedTaskFromISR( tskTCB *pxTCB, portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+		/* The task should not have been on an event list. */
+		configASSERT( pxTCB->xEventListItem.pvContainer == NULL );
 
+		if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+		{
+			vListRemove( &( pxTCB->xGenericListItem ) );
+			prvAddTaskToReadyQueue( pxTCB );
+		}
+		else
+		{
+			/* The delayed and ready lists cannot be accessed, so hold the task
+			pending until the scheduler is resumed. */
+			vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+		}
+
+		if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+		{
+			/* The notified task has a priority above the currently executing
+			task so a yield is required. */
+			if( pxHigherPriorityTaskWoken != NULL )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+		}
+	}
+
+#endif
+/*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if the notification count is not already non-zero. */
+			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			{
+				pxCurrentTCB->eNotifyState = eWaitingNotification;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					prvAddCurrentTaskToBlockedState( xTicksToWait );
+
+					/* The switch is held pending until the critical section
+					is exited. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+			if( ulReturn != 0UL )
+			{
+				if( xClearCountOnExit != pdFALSE )
+				{
+					pxCurrentTCB->ulNotifiedValue = 0UL;
+				}
+				else
+				{
+					pxCurrentTCB->ulNotifiedValue = ulReturn - 1UL;
+				}
+			}
+
+			pxCurrentTCB->eNotifyState = eNotWaitingNotification;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait )
+	{
+	portBASE_TYPE xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if a notification is not already pending. */
+			if( pxCurrentTCB->eNotifyState != eNotified )
+			{
+				/* Clear bits in the task's notification value as bits may get
+				set by the notifying task or interrupt. */
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+				pxCurrentTCB->eNotifyState = eWaitingNotification;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					prvAddCurrentTaskToBlockedState( xTicksToWait );
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			if( pulNotificationValue != NULL )
+			{
+				/* Output the current notification value, which may or may not
+				have changed. */
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+			}
+
+			/* If eNotifyState is still eWaitingNotification then either no
+			block time was given or the task timed out. */
+			if( pxCurrentTCB->eNotifyState == eWaitingNotification )
+			{
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				/* A notification was already pending or a notification was
+				received while the task was waiting. */
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				xReturn = pdTRUE;
+			}
+
+			pxCurrentTCB->eNotifyState = eNotWaitingNotification;
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	/* Apply eAction to the notification value of pxTCB.  Called with
+	interrupts masked.  Returns pdFAIL if a value could not be written. */
+	static portBASE_TYPE prvUpdateNotifiedValue( tskTCB *pxTCB, unsigned long ulValue, eNotifyAction eAction, eNotifyValue eOriginalNotifyState )
+	{
+	portBASE_TYPE xReturn = pdPASS;
+
+		switch( eAction )
+		{
+			case eSetBits	:
+				pxTCB->ulNotifiedValue |= ulValue;
+				break;
+
+			case eIncrement	:
+				( pxTCB->ulNotifiedValue )++;
+				break;
+
+			case eSetValueWithOverwrite	:
+				pxTCB->ulNotifiedValue = ulValue;
+				break;
+
+			case eSetValueWithoutOverwrite :
+				if( eOriginalNotifyState != eNotified )
+				{
+					pxTCB->ulNotifiedValue = ulValue;
+				}
+				else
+				{
+					/* The value could not be written to the task. */
+					xReturn = pdFAIL;
+				}
+				break;
+
+			case eNoAction:
+			default:
+				/* The task is being notified without its notify value being
+				updated. */
+				break;
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue )
+	{
+	tskTCB * pxTCB;
+	eNotifyValue eOriginalNotifyState;
+	portBASE_TYPE xReturn;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		taskENTER_CRITICAL();
+		{
+			if( pulPreviousNotificationValue != NULL )
+			{
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+			}
+
+			eOriginalNotifyState = pxTCB->eNotifyState;
+			pxTCB->eNotifyState = eNotified;
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, eOriginalNotifyState );
+
+			/* If the task is in the blocked state specifically to wait for a
+			notification then unblock it now.  It is not on any event list. */
+			if( eOriginalNotifyState == eWaitingNotification )
+			{
+				vListRemove( &( pxTCB->xGenericListItem ) );
+				prvAddTaskToReadyQueue( pxTCB );
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a yield is required. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	portBASE_TYPE xTaskGenericNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB * pxTCB;
+	eNotifyValue eOriginalNotifyState;
+	portBASE_TYPE xReturn;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( pulPreviousNotificationValue != NULL )
+			{
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+			}
+
+			eOriginalNotifyState = pxTCB->eNotifyState;
+			pxTCB->eNotifyState = eNotified;
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, eOriginalNotifyState );
+
+			if( eOriginalNotifyState == eWaitingNotification )
+			{
+				prvUnblockNotifiedTaskFromISR( pxTCB, pxHigherPriorityTaskWoken );
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB * pxTCB;
+	eNotifyValue eOriginalNotifyState;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			eOriginalNotifyState = pxTCB->eNotifyState;
+			pxTCB->eNotifyState = eNotified;
+
+			/* 'Giving' is equivalent to incrementing a count in a counting
+			semaphore. */
+			( pxTCB->ulNotifiedValue )++;
+
+			if( eOriginalNotifyState == eWaitingNotification )
+			{
+				prvUnblockNotifiedTaskFromISR( pxTCB, pxHigherPriorityTaskWoken );
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
@@ -74,6 +74,10 @@ task.h is included from an application file. */
 #include "queue.h"
 #include "timers.h"
 
+#if ( configTIMER_POOL_SIZE > 0 )
+	#include "mempool.h"
+#endif
+
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
 /* This entire source file will be skipped if the application is not configured
@@ -94,8 +98,27 @@ typedef struct tmrTimerControl
 	unsigned portBASE_TYPE	uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	tmrTIMER_CALLBACK		pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	unsigned char			ucStaticallyAllocated;	/*<< pdTRUE if the application supplied the memory, which is then not freed on delete. */
 } xTIMER;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* xStaticTimerType must be able to hold a timer. */
+	typedef char xStaticTimerMatchesTimer[ ( sizeof( xStaticTimerType ) == sizeof( xTIMER ) ) ? 1 : -1 ];
+#endif
+
+/* Timers come from a block pool when configTIMER_POOL_SIZE asks for it, from
+the heap otherwise. */
+#if ( configTIMER_POOL_SIZE > 0 )
+	PRIVILEGED_DATA static unsigned char ucTimerPoolStorage[ memPOOL_STORAGE_SIZE( sizeof( xTIMER ), configTIMER_POOL_SIZE ) ] memPOOL_ALIGNED;
+	PRIVILEGED_DATA static xMemPool xTimerPool = memPOOL_INITIALISER( ucTimerPoolStorage, sizeof( xTIMER ), configTIMER_POOL_SIZE );
+
+	#define tmrALLOCATE_TIMER()				( xTIMER * ) pvMemPoolTakeOrMalloc( &xTimerPool, sizeof( xTIMER ) )
+	#define tmrFREE_TIMER( pxTimer )		vMemPoolGiveOrFree( &xTimerPool, ( pxTimer ) )
+#else
+	#define tmrALLOCATE_TIMER()				( xTIMER * ) pvPortMalloc( sizeof( xTIMER ) )
+	#define tmrFREE_TIMER( pxTimer )		vPortFree( ( pxTimer ) )
+#endif
+
 /* The definition of messages that can be sent and received on the timer
 queue. */
 typedef struct tmrTimerQueueMessage
@@ -176,6 +199,11 @@ static portTickType prvSampleTimeNow( portBASE_TYPE *pxTimerListsWereSwitched )
  */
 static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty ) PRIVILEGED_FUNCTION;
 
+/*
+ * Fill in a new timer, wherever its memory came from.
+ */
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
+
 /*
  * If a timer has expired, process it.  Otherwise, block the timer service task
  * until either a timer does expire or a command is received.
@@ -227,22 +255,11 @@ xTIMER *pxNewTimer;
 	}
 	else
 	{
-		pxNewTimer = ( xTIMER * ) pvPortMalloc( sizeof( xTIMER ) );
+		pxNewTimer = tmrALLOCATE_TIMER();
 		if( pxNewTimer != NULL )
 		{
-			/* Ensure the infrastructure used by the timer service task has been
-			created/initialised. */
-			prvCheckForValidListAndQueue();
-	
-			/* Initialise the timer structure members using the function parameters. */
-			pxNewTimer->pcTimerName = pcTimerName;
-			pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
-			pxNewTimer->uxAutoReload = uxAutoReload;
-			pxNewTimer->pvTimerID = pvTimerID;
-			pxNewTimer->pxCallbackFunction = pxCallbackFunction;
-			vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
-			
-			traceTIMER_CREATE( pxNewTimer );
+			pxNewTimer->ucStaticallyAllocated = pdFALSE;
+			prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
 		}
 		else
 		{
@@ -254,6 +271,50 @@ xTIMER *pxNewTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimerType *pxTimerBuffer )
+	{
+	xTIMER *pxNewTimer = ( xTIMER * ) pxTimerBuffer;
+
+		configASSERT( pxTimerBuffer );
+		configASSERT( ( xTimerPeriodInTicks > 0 ) );
+
+		if( ( pxNewTimer != NULL ) && ( xTimerPeriodInTicks > ( portTickType ) 0U ) )
+		{
+			pxNewTimer->ucStaticallyAllocated = pdTRUE;
+			prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
+		}
+		else
+		{
+			pxNewTimer = NULL;
+			traceTIMER_CREATE_FAILED();
+		}
+
+		return ( xTimerHandle ) pxNewTimer;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction )
+{
+	/* Ensure the infrastructure used by the timer service task has been
+	created/initialised. */
+	prvCheckForValidListAndQueue();
+
+	/* Initialise the timer structure members using the function parameters. */
+	pxNewTimer->pcTimerName = pcTimerName;
+	pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
+	pxNewTimer->uxAutoReload = uxAutoReload;
+	pxNewTimer->pvTimerID = pvTimerID;
+	pxNewTimer->pxCallbackFunction = pxCallbackFunction;
+	vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+
+	traceTIMER_CREATE( pxNewTimer );
+}
+/*-----------------------------------------------------------*/
+
 portBASE_TYPE xTimerGenericCommand( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime )
 {
 portBASE_TYPE xReturn = pdFAIL;
@@ -564,8 +625,12 @@ portTickType xTimeNow;
 
 			case tmrCOMMAND_DELETE :
 				/* The timer has already been removed from the active list,
-				just free up the memory. */
-				vPortFree( pxTimer );
+				just free up the memory - unless it belongs to the
+				application. */
+				if( pxTimer->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+				{
+					tmrFREE_TIMER( pxTimer );
+				}
 				break;
 
 			default	:			
@@ -0,0 +1,126 @@
+#include <stdint.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "heapstat.h"
+
+/* A live block and the owner slots it is charged to, unused while addr is
+ * NULL.  A slot cannot be reused while a block still points at it, as its
+ * block count is not zero. */
+struct heapstat_block {
+    void *addr;
+    uint8_t caller;
+    uint8_t task;
+};
+
+static struct heapstat_block heapstat_blocks[configHEAPSTAT_BLOCKS];
+static struct heapstat heapstat;
+static const void *heapstat_next_caller;
+
+/* The slot already held by owner, else the first unused one, else the last
+ * (shared) one. */
+static uint8_t heapstat_slot(struct heapstat_owner *table, unsigned count, const void *owner)
+{
+    unsigned i, unused = count;
+
+    for (i = 0; i < count; i++) {
+        if (!table[i].blocks) {
+            if (unused == count)
+                unused = i;
+        }
+        else if (table[i].owner == owner) {
+            return i;
+        }
+    }
+
+    if (unused < count) {
+        table[unused].owner = owner;
+        table[unused].bytes = 0;
+    }
+    return unused;
+}
+
+static void heapstat_charge(struct heapstat_owner *owner, size_t size)
+{
+    owner->bytes += size;
+    owner->blocks++;
+}
+
+static void heapstat_release(struct heapstat_owner *owner, size_t size)
+{
+    owner->bytes -= size;
+    owner->blocks--;
+}
+
+void heapstat_malloc(void *addr, size_t size, const void *caller)
+{
+    struct heapstat_block *b;
+    const void *task = NULL;
+    unsigned i;
+
+    if (heapstat_next_caller) {
+        caller = heapstat_next_caller;
+        heapstat_next_caller = NULL;
+    }
+
+    if (!addr) {
+        heapstat.failed++;
+        return;
+    }
+
+    for (i = 0; i < configHEAPSTAT_BLOCKS && heapstat_blocks[i].addr; i++);
+    if (i == configHEAPSTAT_BLOCKS) {
+        heapstat_charge(&heapstat.untracked, size);
+        return;
+    }
+
+#if defined(__thumb__)
+    /* Drop the Thumb bit so the address matches the listing. */
+    caller = (const void *) ((uintptr_t) caller & ~(uintptr_t) 1);
+#endif
+
+    /* Before the scheduler starts the current task is merely the highest
+     * priority one created so far, charge main() instead. */
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        task = xTaskGetCurrentTaskHandle();
+
+    b = &heapstat_blocks[i];
+    b->addr = addr;
+    b->caller = heapstat_slot(heapstat.callers, configHEAPSTAT_CALLERS, caller);
+    b->task = heapstat_slot(heapstat.tasks, configHEAPSTAT_TASKS, task);
+    heapstat_charge(&heapstat.callers[b->caller], size);
+    heapstat_charge(&heapstat.tasks[b->task], size);
+}
+
+void heapstat_free(void *addr, size_t size)
+{
+    struct heapstat_block *b;
+    unsigned i;
+
+    for (i = 0; i < configHEAPSTAT_BLOCKS && heapstat_blocks[i].addr != addr; i++);
+    if (i == configHEAPSTAT_BLOCKS) {
+        if (heapstat.untracked.blocks)
+            heapstat_release(&heapstat.untracked, size);
+        return;
+    }
+
+    b = &heapstat_blocks[i];
+    heapstat_release(&heapstat.callers[b->caller], size);
+    heapstat_release(&heapstat.tasks[b->task], size);
+    b->addr = NULL;
+}
+
+void heapstat_on_behalf_of(const void *caller)
+{
+    heapstat_next_caller = caller;
+}
+
+void heapstat_snapshot(struct heapstat *snap)
+{
+    vTaskSuspendAll();
+    memcpy(snap, &heapstat, sizeof(*snap));
+    xTaskResumeAll();
+}
@@ -0,0 +1,59 @@
+#ifndef __HEAPSTAT_H__
+#define __HEAPSTAT_H__
+
+/* Heap ownership accounting.
+ *
+ * The kernel heap hooks (traceMALLOC / traceFREE, see FreeRTOSConfig.h)
+ * report every block handed out and returned, together with the return
+ * address of the pvPortMalloc() call - or of the pvMemPoolTakeOrMalloc() call
+ * for kernel objects that found their pool empty.  Live bytes and blocks are
+ * totalled per calling site and per task; look the addresses up in main.list
+ * or with addr2line.  Blocks are remembered in a fixed table so a free is charged back
+ * to whoever allocated it, once the table is full further blocks are only
+ * counted as untracked.  Sizes are whole heap blocks, headers included.
+ *
+ * The allocator's own figures - free space, low water mark, free block
+ * histogram - come from vPortGetHeapStats(). */
+
+/* This header is pulled in by FreeRTOSConfig.h, keep it free of kernel
+ * includes. */
+#include <stddef.h>
+
+/* Table sizes: live blocks tracked, and owner slots per table. */
+#ifndef configHEAPSTAT_BLOCKS
+#define configHEAPSTAT_BLOCKS 24
+#endif
+#ifndef configHEAPSTAT_CALLERS
+#define configHEAPSTAT_CALLERS 12
+#endif
+#ifndef configHEAPSTAT_TASKS
+#define configHEAPSTAT_TASKS 8
+#endif
+
+struct heapstat_owner {
+    const void *owner;          /* return address, or task handle (NULL
+                                 * before the scheduler starts) */
+    unsigned long bytes;        /* live */
+    unsigned short blocks;      /* live, the slot is unused while zero */
+};
+
+/* The last slot of each table collects the owners that found no free one. */
+struct heapstat {
+    struct heapstat_owner callers[configHEAPSTAT_CALLERS + 1];
+    struct heapstat_owner tasks[configHEAPSTAT_TASKS + 1];
+    struct heapstat_owner untracked;
+    unsigned long failed;       /* allocations the heap refused */
+};
+
+/* Copy the current totals. */
+void heapstat_snapshot(struct heapstat *snap);
+
+/* Called through the kernel heap hooks, with the scheduler suspended. */
+void heapstat_malloc(void *addr, size_t size, const void *caller);
+void heapstat_free(void *addr, size_t size);
+
+/* Called through traceMALLOC_ON_BEHALF_OF: charge the next block to caller
+ * rather than to the return address of the pvPortMalloc() call. */
+void heapstat_on_behalf_of(const void *caller);
+
+#endif
@@ -11,6 +11,7 @@ union param_t
 
 typedef union param_t param;
 
+#if defined(__arm__)
 static int host_call(enum HOST_SYSCALL action, void *arg) __attribute__ ((naked));
 static int host_call(enum HOST_SYSCALL action, void *arg)
 {
@@ -25,6 +26,67 @@ static int host_call(enum HOST_SYSCALL action, void *arg)
         :::\
     );
 }
+#else
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+/* Native (make host) builds have no debugger to trap into, so serve the
+ * calls directly with the POSIX equivalents, keeping the semihosting return
+ * conventions (READ/WRITE return the number of bytes NOT transferred). */
+static int host_call(enum HOST_SYSCALL action, void *arg)
+{
+    static const int open_flags[] = {
+        [OPEN_RD]              = O_RDONLY,
+        [OPEN_RD_BIN]          = O_RDONLY,
+        [OPEN_RD_ONLY]         = O_RDWR,
+        [OPEN_RD_ONLY_BIN]     = O_RDWR,
+        [OPEN_WR]              = O_WRONLY | O_CREAT | O_TRUNC,
+        [OPEN_WR_BIN]          = O_WRONLY | O_CREAT | O_TRUNC,
+        [OPEN_WR_ONLY]         = O_RDWR | O_CREAT | O_TRUNC,
+        [OPEN_WR_ONLY_BIN]     = O_RDWR | O_CREAT | O_TRUNC,
+        [OPEN_APPEND]          = O_WRONLY | O_CREAT | O_APPEND,
+        [OPEN_APPEND_BIN]      = O_WRONLY | O_CREAT | O_APPEND,
+        [OPEN_APPEND_ONLY]     = O_RDWR | O_CREAT | O_APPEND,
+        [OPEN_APPEND_ONLY_BIN] = O_RDWR | O_CREAT | O_APPEND,
+    };
+    param *p = (param *) arg;
+    struct stat st;
+    char cmd[256];
+    ssize_t n;
+
+    switch (action) {
+    case HOSTCALL_OPEN:
+        if (p[1].pdInt < 0 || p[1].pdInt > OPEN_APPEND_ONLY_BIN)
+            return -1;
+        /* ":tt" is the debugger console. */
+        if (!strcmp(p[0].pdChrPtr, ":tt"))
+            return dup(p[1].pdInt < OPEN_WR ? STDIN_FILENO : STDOUT_FILENO);
+        return open(p[0].pdChrPtr, open_flags[p[1].pdInt], 0644);
+    case HOSTCALL_CLOSE:
+        return close(*(int *) arg);
+    case HOSTCALL_WRITE:
+        n = write(p[0].pdInt, p[1].pdPtr, p[2].pdInt);
+        return n < 0 ? p[2].pdInt : p[2].pdInt - n;
+    case HOSTCALL_READ:
+        n = read(p[0].pdInt, p[1].pdPtr, p[2].pdInt);
+        return n < 0 ? p[2].pdInt : p[2].pdInt - n;
+    case HOSTCALL_SEEK:
+        return lseek(p[0].pdInt, p[1].pdInt, SEEK_SET) < 0 ? -1 : 0;
+    case HOSTCALL_FLEN:
+        return fstat(*(int *) arg, &st) < 0 ? -1 : st.st_size;
+    case HOSTCALL_SYSTEM:
+        if (p[1].pdInt >= sizeof(cmd))
+            return -1;
+        memcpy(cmd, p[0].pdChrPtr, p[1].pdInt);
+        cmd[p[1].pdInt] = '\0';
+        return system(cmd);
+    default:
+        return -1;
+    }
+}
+#endif
 
 /* Detailed parameters please refer to
  * http://infocenter.arm.com/help/index.jsp?topic=/com.arm.doc.dui0471c/Bgbjhiea.html */
@@ -66,6 +128,21 @@ int host_close(int fd)
     return host_call(HOSTCALL_CLOSE, (void *)&fd);
 }
 
+int host_seek(int fd, int pos)
+{
+    param semi_param[2] = {
+        { .pdInt = fd },
+        { .pdInt = pos }
+    };
+
+    return host_call(HOSTCALL_SEEK, semi_param) ? -1 : 0;
+}
+
+int host_flen(int fd)
+{
+    return host_call(HOSTCALL_FLEN, (void *)&fd);
+}
+
 int host_system(char *cmd, int str_len)
 {
     param semi_param[3] = {
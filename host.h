@@ -50,5 +50,8 @@ size_t host_write(int fd, const void *buf, size_t count);
 
 int host_open(const char *pathname, int flags);
 int host_close(int fd);
+/* Absolute positions only, 0 or -1.  host_flen() returns the size or -1. */
+int host_seek(int fd, int pos);
+int host_flen(int fd);
 int host_system(char *cmd, int str_len);
 #endif
@@ -0,0 +1,208 @@
+#include <string.h>
+#include <FreeRTOS.h>
+#include <unistd.h>
+#include "fio.h"
+#include "filesystem.h"
+#include "hostfs.h"
+#include "host.h"
+
+struct hostfs_file_t {
+    int handle;                 /* the host's */
+    uint32_t pos;               /* where the next read or write goes */
+    uint32_t host_pos;          /* where the host handle points */
+    uint32_t buf_pos;           /* file offset of buf[0] */
+    uint32_t len;               /* bytes in buf */
+    int dirty;                  /* buf holds writes the host has not seen */
+    char buf[HOSTFS_BUF_SIZE];
+};
+
+static int hostfs_host_seek(struct hostfs_file_t * f, uint32_t pos) {
+    if (f->host_pos == pos)
+        return 0;
+    if (host_seek(f->handle, pos))
+        return -1;
+    f->host_pos = pos;
+    return 0;
+}
+
+/* Hands the pending writes to the host, in one call. */
+static int hostfs_flush(struct hostfs_file_t * f) {
+    int r = 0;
+
+    if (f->dirty) {
+        if (hostfs_host_seek(f, f->buf_pos) || host_write(f->handle, f->buf, f->len))
+            r = -1;
+        else
+            f->host_pos = f->buf_pos + f->len;
+        f->dirty = 0;
+    }
+    f->len = 0;
+    return r;
+}
+
+static ssize_t hostfs_read(void * opaque, void * buf, size_t count) {
+    struct hostfs_file_t * f = (struct hostfs_file_t *) opaque;
+    size_t n;
+
+    if (f->dirty && hostfs_flush(f))
+        return -1;
+
+    /* Refill unless the position is buffered.  A read at least the size
+     * of the buffer goes straight to the caller's memory. */
+    if (f->pos < f->buf_pos || f->pos >= f->buf_pos + f->len) {
+        f->len = 0;
+        if (hostfs_host_seek(f, f->pos))
+            return -1;
+        if (count >= HOSTFS_BUF_SIZE) {
+            n = count - host_read(f->handle, buf, count);
+            f->host_pos += n;
+            f->pos += n;
+            return n;
+        }
+        f->buf_pos = f->pos;
+        f->len = HOSTFS_BUF_SIZE - host_read(f->handle, f->buf, HOSTFS_BUF_SIZE);
+        f->host_pos += f->len;
+    }
+
+    n = f->buf_pos + f->len - f->pos;
+    if (n > count)
+        n = count;
+    memcpy(buf, f->buf + (f->pos - f->buf_pos), n);
+    f->pos += n;
+    return n;
+}
+
+static ssize_t hostfs_write(void * opaque, const void * buf, size_t count) {
+    struct hostfs_file_t * f = (struct hostfs_file_t *) opaque;
+    const char * data = (const char *) buf;
+    size_t done = 0, n;
+
+    /* Read-ahead is dropped, and pending writes that this one does not
+     * continue go out first. */
+    if (!f->dirty || f->pos != f->buf_pos + f->len) {
+        if (hostfs_flush(f))
+            return -1;
+        f->buf_pos = f->pos;
+    }
+
+    if (!f->len && count >= HOSTFS_BUF_SIZE) {
+        if (hostfs_host_seek(f, f->pos) || host_write(f->handle, data, count))
+            return -1;
+        f->host_pos += count;
+        f->pos += count;
+        f->buf_pos = f->pos;
+        return count;
+    }
+
+    while (done < count) {
+        n = HOSTFS_BUF_SIZE - f->len;
+        if (n > count - done)
+            n = count - done;
+        memcpy(f->buf + f->len, data + done, n);
+        f->len += n;
+        f->dirty = 1;
+        done += n;
+        f->pos += n;
+        if (f->len == HOSTFS_BUF_SIZE) {
+            if (hostfs_flush(f))
+                return -1;
+            f->buf_pos = f->pos;
+        }
+    }
+
+    return done;
+}
+
+static off_t hostfs_seek(void * opaque, off_t offset, int whence) {
+    struct hostfs_file_t * f = (struct hostfs_file_t *) opaque;
+    int size;
+    uint32_t origin;
+
+    switch (whence) {
+    case SEEK_SET:
+        origin = 0;
+        break;
+    case SEEK_CUR:
+        origin = f->pos;
+        break;
+    case SEEK_END:
+        if (hostfs_flush(f))
+            return -1;
+        size = host_flen(f->handle);
+        if (size < 0)
+            return -1;
+        origin = size;
+        break;
+    default:
+        return -1;
+    }
+
+    offset = origin + offset;
+    if (offset < 0)
+        return -1;
+
+    /* Only moves the position, the buffers sort it out on the next
+     * read or write. */
+    f->pos = offset;
+    return offset;
+}
+
+static int hostfs_close(void * opaque) {
+    struct hostfs_file_t * f = (struct hostfs_file_t *) opaque;
+    int r = hostfs_flush(f);
+
+    if (host_close(f->handle))
+        r = -1;
+    vPortFree(f);
+    return r;
+}
+
+/* fio flags to the fopen() style modes semihosting takes, always binary. */
+static int hostfs_mode(int flags) {
+    if (flags & O_RDWR) {
+        if (flags & O_APPEND)
+            return OPEN_APPEND_ONLY_BIN;        /* "a+b" */
+        if (flags & (O_CREAT | O_TRUNC))
+            return OPEN_WR_ONLY_BIN;            /* "w+b" */
+        return OPEN_RD_ONLY_BIN;                /* "r+b" */
+    }
+    if (flags & O_WRONLY)
+        return flags & O_APPEND ? OPEN_APPEND_BIN : OPEN_WR_BIN;
+    return OPEN_RD_BIN;
+}
+
+static int hostfs_open(void * opaque, const char * path, int flags, int mode) {
+    struct hostfs_file_t * f;
+    int size, r;
+
+    f = pvPortMalloc(sizeof(struct hostfs_file_t));
+    if (!f)
+        return -1;
+
+    f->handle = host_open(path, hostfs_mode(flags));
+    if (f->handle < 0) {
+        vPortFree(f);
+        return -1;
+    }
+    f->pos = f->host_pos = f->buf_pos = 0;
+    f->len = 0;
+    f->dirty = 0;
+
+    /* Appends land at the end whatever the position, start there. */
+    if (flags & O_APPEND) {
+        size = host_flen(f->handle);
+        if (size > 0)
+            f->pos = f->buf_pos = size;
+    }
+
+    r = fio_open(hostfs_read, hostfs_write, hostfs_seek, hostfs_close, f);
+    if (r < 0) {
+        host_close(f->handle);
+        vPortFree(f);
+    }
+    return r;
+}
+
+void register_hostfs(const char * mountpoint) {
+    register_fs(mountpoint, hostfs_open, NULL);
+}
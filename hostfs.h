@@ -0,0 +1,16 @@
+#ifndef __HOSTFS_H__
+#define __HOSTFS_H__
+
+/* Files of the debugging host, reached over semihosting.  fs_open() of
+ * "/<mountpoint>/path" opens "path" relative to the host's working
+ * directory (that of QEMU or the debugger, or of main-host itself).
+ *
+ * Every semihosting call stops the core for a debugger round trip, so
+ * reads are served from a read-ahead buffer and writes collect in the same
+ * buffer until it fills, the file is seeked or closed. */
+
+#define HOSTFS_BUF_SIZE 256     /* per open file, from the heap */
+
+void register_hostfs(const char * mountpoint);
+
+#endif
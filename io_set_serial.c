@@ -1,95 +1,333 @@
 #include "io_set_serial.h"
 
+#include <string.h>
+
 #include "stm32f10x.h"
 #include "stm32_p103.h"
 #include "FreeRTOS.h"
-#include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
-#include "semphr.h"
+#include "hostfs.h"
 
 extern const char _sromfs;
-static volatile xSemaphoreHandle serial_tx_wait_sem = NULL;
-static volatile xQueueHandle serial_rx_queue = NULL;
+
+/* Tasks blocked on the serial port.  The interrupts wake them with a direct
+ * task notification, so no semaphore has to be allocated or locked. */
+static volatile xTaskHandle serial_tx_waiter = NULL;
+static volatile xTaskHandle serial_rx_waiter = NULL;
+
+/* Transmit ring.  Tasks append at serial_tx_head, the DMA (or the TXE
+ * interrupt) drains from serial_tx_tail.  serial_tx_busy is the number of
+ * bytes currently handed to the DMA. */
+static char serial_tx_buf[SERIAL_TX_BUF_SIZE];
+static volatile unsigned int serial_tx_head = 0;
+static volatile unsigned int serial_tx_tail = 0;
+static volatile unsigned int serial_tx_busy = 0;
+
+#define SERIAL_TX_MASK (SERIAL_TX_BUF_SIZE - 1)
+
+/* Receive ring, single producer (USART2 interrupt) and single consumer
+ * (the reading task), so no lock is needed: the interrupt only moves
+ * serial_rx_head and the task only moves serial_rx_tail.  A reader that
+ * has to block publishes how many bytes it still needs in serial_rx_want,
+ * at most half the ring so the interrupt has room to go on storing, and
+ * the interrupt notifies serial_rx_waiter once they are there, or once the
+ * line goes idle. */
+static char serial_rx_buf[SERIAL_RX_BUF_SIZE];
+static volatile unsigned int serial_rx_head = 0;
+static volatile unsigned int serial_rx_tail = 0;
+static volatile unsigned int serial_rx_want = 0;
+static volatile char serial_rx_idle = 0;
+static volatile unsigned long serial_rx_overflows = 0;
+
+#define SERIAL_RX_MASK (SERIAL_RX_BUF_SIZE - 1)
+#define serial_rx_count() ((serial_rx_head - serial_rx_tail) & SERIAL_RX_MASK)
+
+/* Wake the writer waiting for ring space, if any.  Called from the
+ * transmit interrupts. */
+static void serial_tx_wake(portBASE_TYPE *pxHigherPriorityTaskWoken)
+{
+	xTaskHandle waiter = serial_tx_waiter;
+
+	if (waiter) {
+		serial_tx_waiter = NULL;
+		vTaskNotifyGiveFromISR(waiter, pxHigherPriorityTaskWoken);
+	}
+}
+
+/* Wake the reader once the bytes it wants are in, or the line went idle;
+ * the reader tells whether it has anything to return. */
+static void serial_rx_wake(portBASE_TYPE *pxHigherPriorityTaskWoken)
+{
+	unsigned int want = serial_rx_want;
+
+	if (want && (serial_rx_count() >= want || serial_rx_idle)) {
+		serial_rx_want = 0;
+		vTaskNotifyGiveFromISR(serial_rx_waiter, pxHigherPriorityTaskWoken);
+	}
+}
+
+/* Start draining the ring if it is idle and has data.  Called with
+ * interrupts masked (critical section or the transmit interrupt). */
+static void serial_tx_kick()
+{
+	unsigned int head = serial_tx_head;
+	unsigned int tail = serial_tx_tail;
+
+	if (serial_tx_busy || head == tail)
+		return;
+
+#if SERIAL_TX_USE_DMA
+	/* One transfer per contiguous run; a wrapped ring takes two. */
+	serial_tx_busy = (head > tail ? head : SERIAL_TX_BUF_SIZE) - tail;
+	DMA1_Channel7->CMAR = (uint32_t) &serial_tx_buf[tail];
+	DMA_SetCurrDataCounter(DMA1_Channel7, serial_tx_busy);
+	DMA_Cmd(DMA1_Channel7, ENABLE);
+#else
+	serial_tx_busy = 1;
+	USART_ITConfig(USART2, USART_IT_TXE, ENABLE);
+#endif
+}
+
+#if SERIAL_TX_USE_DMA
+/* IRQ handler for the end of a USART2 transmit DMA transfer. */
+void DMA1_Channel7_IRQHandler()
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	traceISR_ENTER();
+
+	if (DMA_GetITStatus(DMA1_IT_TC7) != RESET) {
+		DMA_ClearITPendingBit(DMA1_IT_GL7);
+		DMA_Cmd(DMA1_Channel7, DISABLE);
+
+		/* Release the bytes just sent and queue the next run. */
+		serial_tx_tail = (serial_tx_tail + serial_tx_busy) & SERIAL_TX_MASK;
+		serial_tx_busy = 0;
+		serial_tx_kick();
+
+		serial_tx_wake(&xHigherPriorityTaskWoken);
+	}
+
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+#endif
 
 /* IRQ handler to handle USART2 interruptss (both transmit and receive
  * interrupts). */
 void USART2_IRQHandler()
 {
-	static signed portBASE_TYPE xHigherPriorityTaskWoken;
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	unsigned int head;
 	char rx_msg;
+
+	traceISR_ENTER();
+
 	/* If this interrupt is for a transmit... */
 	if (USART_GetITStatus(USART2, USART_IT_TXE) != RESET) {
-		/* "give" the serial_tx_wait_sem semaphore to notfiy processes
-		 * that the buffer has a spot free for the next byte.
-		 */
-		xSemaphoreGiveFromISR(serial_tx_wait_sem, &xHigherPriorityTaskWoken);
-
-		/* Diables the transmit interrupt. */
+#if SERIAL_TX_USE_DMA
+		/* The transmitter is fed by DMA, TXE should never be enabled. */
 		USART_ITConfig(USART2, USART_IT_TXE, DISABLE);
-		/* If this interrupt is for a receive... */
+#else
+		/* Push the next byte of the ring, or disable the transmit
+		 * interrupt once it runs dry. */
+		if (serial_tx_tail != serial_tx_head) {
+			USART_SendData(USART2, serial_tx_buf[serial_tx_tail]);
+			serial_tx_tail = (serial_tx_tail + 1) & SERIAL_TX_MASK;
+			serial_tx_wake(&xHigherPriorityTaskWoken);
+		}
+		else {
+			serial_tx_busy = 0;
+			USART_ITConfig(USART2, USART_IT_TXE, DISABLE);
+		}
+#endif
+	}
+
+	/* If this interrupt is for a receive... */
+	if (USART_GetITStatus(USART2, USART_IT_RXNE) != RESET) {
+		/* Receive the byte from the buffer. */
+		rx_msg = USART_ReceiveData(USART2);
+
+		/* Store it in the ring, or count it as lost when the reader
+		 * has fallen a whole ring behind. */
+		head = serial_rx_head;
+		if (((head + 1) & SERIAL_RX_MASK) == serial_rx_tail) {
+			serial_rx_overflows++;
+		}
+		else {
+			serial_rx_buf[head] = rx_msg;
+			serial_rx_head = (head + 1) & SERIAL_RX_MASK;
+		}
+		serial_rx_idle = 0;
+
+		serial_rx_wake(&xHigherPriorityTaskWoken);
 	}
-        else if (USART_GetITStatus(USART2, USART_IT_RXNE) != RESET) {
-                /* Receive the byte from the buffer. */
-                rx_msg = USART_ReceiveData(USART2);
-
-                /* Queue the received byte. */
-                if(!xQueueSendToBackFromISR(serial_rx_queue, &rx_msg, &xHigherPriorityTaskWoken)) {
-                        /* If there was an error queueing the received byte,
-                         * freeze. */
-                        while(1);
-                }
-        }
-
-	else {
-		/* Only transmit and receive interrupts should be enabled.
-		 * If this is another type of interrupt, freeze.
-		 */
-		while(1);
+
+	/* If the line went quiet after a burst, hand over what we have.  The
+	 * flag is cleared by reading SR (done above) followed by DR. */
+	if (USART_GetITStatus(USART2, USART_IT_IDLE) != RESET) {
+		USART_ReceiveData(USART2);
+		serial_rx_idle = 1;
+
+		serial_rx_wake(&xHigherPriorityTaskWoken);
 	}
 
-	if (xHigherPriorityTaskWoken) {
-		taskYIELD();
+	/* A byte was overwritten in the data register before we got to it. */
+	if (USART_GetITStatus(USART2, USART_IT_ORE) != RESET) {
+		USART_ReceiveData(USART2);
+		serial_rx_overflows++;
+	}
+
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+void send_bytes(const char *buf, size_t count)
+{
+	unsigned int head, space, chunk;
+	portBASE_TYPE wait;
+
+	while (count) {
+		taskENTER_CRITICAL();
+		{
+			/* Copy as much as fits, in at most two runs around the
+			 * end of the ring.  One slot stays free so a full ring
+			 * is distinguishable from an empty one. */
+			head = serial_tx_head;
+			space = (serial_tx_tail - head - 1) & SERIAL_TX_MASK;
+			if (space > count)
+				space = count;
+			count -= space;
+
+			while (space) {
+				chunk = SERIAL_TX_BUF_SIZE - head;
+				if (chunk > space)
+					chunk = space;
+				memcpy(&serial_tx_buf[head], buf, chunk);
+				head = (head + chunk) & SERIAL_TX_MASK;
+				buf += chunk;
+				space -= chunk;
+			}
+			serial_tx_head = head;
+
+			serial_tx_kick();
+
+			/* Ring is full: register to be woken when the transmitter
+			 * frees some space.  Only one writer can be registered,
+			 * any other one rechecks every tick. */
+			wait = pdFALSE;
+			if (count && !serial_tx_waiter) {
+				serial_tx_waiter = xTaskGetCurrentTaskHandle();
+				wait = pdTRUE;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if (wait)
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		else if (count)
+			vTaskDelay(1);
 	}
 }
 
 void send_byte(char ch)
 {
-	/* Wait until the RS232 port can receive another byte (this semaphore
-	 * is "given" by the RS232 port interrupt when the buffer has room for
-	 * another byte.
-	 */
-	while (!xSemaphoreTake(serial_tx_wait_sem, portMAX_DELAY));
-
-	/* Send the byte and enable the transmit interrupt (it is disabled by
-	 * the interrupt).
-	 */
-	USART_SendData(USART2, ch);
-	USART_ITConfig(USART2, USART_IT_TXE, ENABLE);
+	send_bytes(&ch, 1);
+}
+
+static size_t serial_rx_pop(char *buf, size_t count)
+{
+	unsigned int tail = serial_rx_tail;
+	unsigned int head = serial_rx_head;
+	size_t n = 0;
+
+	while (n < count && tail != head) {
+		buf[n++] = serial_rx_buf[tail];
+		tail = (tail + 1) & SERIAL_RX_MASK;
+	}
+	serial_rx_tail = tail;
+
+	return n;
+}
+
+size_t receive_bytes(char *buf, size_t count, portTickType timeout)
+{
+	size_t got, want;
+	portBASE_TYPE wait;
+	xTimeOutType timeout_state;
+
+	got = serial_rx_pop(buf, count);
+	if (got == count || (got && serial_rx_idle))
+		return got;
+
+	/* Drop a wakeup left over from an earlier read that timed out. */
+	ulTaskNotifyTake(pdTRUE, 0);
+
+	vTaskSetTimeOutState(&timeout_state);
+	for (;;) {
+		/* The ring never holds more than SERIAL_RX_MASK bytes, so a
+		 * long read is taken in chunks of half of it. */
+		want = count - got;
+		if (want > SERIAL_RX_BUF_SIZE / 2)
+			want = SERIAL_RX_BUF_SIZE / 2;
+
+		taskENTER_CRITICAL();
+		{
+			/* A burst already partly taken ends when the line
+			 * goes idle, even if the ring is empty by then. */
+			wait = serial_rx_count() < want && !(got && serial_rx_idle);
+			if (wait) {
+				serial_rx_waiter = xTaskGetCurrentTaskHandle();
+				serial_rx_want = want;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if (!wait) {
+			got += serial_rx_pop(buf + got, count - got);
+			if (got == count || serial_rx_idle)
+				break;
+			continue;
+		}
+
+		if (xTaskCheckForTimeOut(&timeout_state, &timeout))
+			break;
+
+		/* The notification value is shared with the transmit side, so
+		 * a wakeup only means it is worth looking at the ring again. */
+		if (ulTaskNotifyTake(pdTRUE, timeout) &&
+		    serial_rx_idle && (got || serial_rx_count()))
+			break;
+	}
+	serial_rx_want = 0;
+
+	return got + serial_rx_pop(buf + got, count - got);
 }
 
 char receive_byte()
 {
 	char msg;
 
-	/* Wait for a byte to be queued by the receive interrupts handler. */
-	while (!xQueueReceive(serial_rx_queue, &msg, portMAX_DELAY));
+	/* Wait for a byte to be stored by the receive interrupt handler. */
+	while (!receive_bytes(&msg, 1, portMAX_DELAY));
 	return msg;
 }
 
+unsigned long serial_rx_overflow_count()
+{
+	return serial_rx_overflows;
+}
+
 void Init_Serial()
 {
 	init_rs232();
+#if SERIAL_TX_USE_DMA
+	init_rs232_dma();
+#endif
 	enable_rs232_interrupts();
 	enable_rs232();
 	
 	fs_init();
 	fio_init();
 	register_romfs("romfs", &_sromfs);
-	/* Create the queue used by the serial task.  Messages for write to
-	 * the RS232. */
-	vSemaphoreCreateBinary(serial_tx_wait_sem);
-	serial_rx_queue = xQueueCreate(1, sizeof(char));
-
+	register_hostfs("host");
 }
 
@@ -1,9 +1,34 @@
 #ifndef IO_SET_SERIAL_H
 #define IO_SET_SERIAL_H
 
+#include <stddef.h>
+#include "FreeRTOS.h"
+
+/* Size of the transmit ring, must be a power of two. */
+#define SERIAL_TX_BUF_SIZE 256
+
+/* Size of the receive ring, must be a power of two. */
+#define SERIAL_RX_BUF_SIZE 128
+
+/* Drain the transmit ring with DMA1 channel 7.  Set to 0 to feed the USART
+ * from the TXE interrupt instead (e.g. on emulators without a DMA model). */
+#ifndef SERIAL_TX_USE_DMA
+#define SERIAL_TX_USE_DMA 1
+#endif
+
 void Init_Serial();
 void USART2_IRQHandler();
 void send_byte(char ch);
+void send_bytes(const char *buf, size_t count);
 char receive_byte();
 
+/* Receive up to count bytes.  Blocks until count bytes have arrived, the
+ * line goes idle with at least one byte buffered, or timeout ticks pass.
+ * Returns the number of bytes copied into buf. */
+size_t receive_bytes(char *buf, size_t count, portTickType timeout);
+
+/* Number of received bytes dropped because the ring or the USART data
+ * register overflowed. */
+unsigned long serial_rx_overflow_count();
+
 #endif
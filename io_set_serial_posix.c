@@ -0,0 +1,138 @@
+#include "io_set_serial.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <termios.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "filesystem.h"
+#include "romfs.h"
+#include "hostfs.h"
+
+/* Stand-in for the USART2 driver in the native (make host) build: the serial
+ * port is the terminal the simulator runs in, stdout for transmit and a
+ * non-blocking stdin polled every few ticks for receive.  The board's other
+ * hooks that the kernel needs are here as well. */
+
+extern const char _sromfs;
+
+void fio_init();
+
+static struct termios saved_termios;
+static int saved_stdin_flags;
+
+static void restore_stdin()
+{
+	if (isatty(STDIN_FILENO))
+		tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+	fcntl(STDIN_FILENO, F_SETFL, saved_stdin_flags);
+}
+
+void send_bytes(const char *buf, size_t count)
+{
+	ssize_t n;
+
+	while (count) {
+		n = write(STDOUT_FILENO, buf, count);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+		buf += n;
+		count -= n;
+	}
+}
+
+void send_byte(char ch)
+{
+	send_bytes(&ch, 1);
+}
+
+size_t receive_bytes(char *buf, size_t count, portTickType timeout)
+{
+	xTimeOutType xTimeOut;
+	ssize_t n;
+
+	vTaskSetTimeOutState(&xTimeOut);
+	for (;;) {
+		n = read(STDIN_FILENO, buf, count);
+		if (n > 0)
+			return n;
+
+		/* Nothing more will ever arrive once stdin is closed, which
+		 * is how a script piped into the simulator ends. */
+		if (n == 0 || (errno != EAGAIN && errno != EINTR))
+			exit(0);
+
+		if (xTaskCheckForTimeOut(&xTimeOut, &timeout))
+			return 0;
+
+		/* Poll every 50ms so the idle task can sleep in between. */
+		vTaskDelay(50 / portTICK_RATE_MS);
+	}
+}
+
+char receive_byte()
+{
+	char msg;
+
+	while (!receive_bytes(&msg, 1, portMAX_DELAY));
+	return msg;
+}
+
+unsigned long serial_rx_overflow_count()
+{
+	return 0;
+}
+
+void Init_Serial()
+{
+	struct termios raw;
+
+	/* Behave like a serial line: no line buffering or local echo, the
+	 * shell echoes and edits the input itself. */
+	saved_stdin_flags = fcntl(STDIN_FILENO, F_GETFL);
+	if (isatty(STDIN_FILENO)) {
+		tcgetattr(STDIN_FILENO, &saved_termios);
+		raw = saved_termios;
+		raw.c_lflag &= ~(ICANON | ECHO);
+		raw.c_iflag &= ~ICRNL;
+		raw.c_cc[VMIN] = 1;
+		raw.c_cc[VTIME] = 0;
+		tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+	}
+	fcntl(STDIN_FILENO, F_SETFL, saved_stdin_flags | O_NONBLOCK);
+	atexit(restore_stdin);
+
+	fs_init();
+	fio_init();
+	register_romfs("romfs", &_sromfs);
+	register_hostfs("host");
+}
+
+/* The run time statistics counter, at configRUN_TIME_COUNTER_HZ from the
+ * host's monotonic clock instead of TIM2. */
+static struct timespec run_time_start;
+
+void init_run_time_timer()
+{
+	clock_gettime(CLOCK_MONOTONIC, &run_time_start);
+}
+
+unsigned long get_run_time_timer()
+{
+	struct timespec now;
+	unsigned long long ns;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	ns = (now.tv_sec - run_time_start.tv_sec) * 1000000000ULL +
+	     now.tv_nsec - run_time_start.tv_nsec;
+
+	/* Wrap at 32 bits like the target's counter. */
+	return (unsigned int) (ns / (1000000000UL / configRUN_TIME_COUNTER_HZ));
+}
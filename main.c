@@ -1,6 +1,4 @@
-#define USE_STDPERIPH_DRIVER
-#include "stm32f10x.h"
-#include "stm32_p103.h"
+#include <string.h>
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
@@ -12,47 +10,50 @@
 #include "io_set_serial.h"
 #include "filesystem.h"
 #include "fio.h"
+#include "fio-stream.h"
 #include "host.h"
+#include "bench/bench.h"
+#include "trace/trace.h"
+#include "heapstat/heapstat.h"
+#include "string-util.h"
+#include "shell.h"
 
 #define MAX_SERIAL_STR 100
-#define Command_Number 8
-
-enum ALLcommand 
-{
-/*Add your command in here. */
-    hello,
-    echo,
-    ps,
-    help,
-    host,
-    cat,
-    ls,
-    mmtest,
-};
 
-struct STcommand
+void hello_command(int argc, char *argv[])
 {
-	char *name;
-	int  size; 	
-	char *info;
-};
-typedef struct STcommand CmdList;
-CmdList CMD[]={
-	   /*Add your command list in here. */
+	Print("Hello! how are you?");
+}
 
-      [hello]   = {.name="hello"   , .size=5 , .info="Show 'Hello! how are you?'"},
-      [echo]    = {.name="echo"    , .size=4 , .info="Show your input"},
-      [ps]      = {.name="ps"      , .size=2 , .info="Report current processes"},
-      [help]    = {.name="help"    , .size=4 , .info="Show command list."},
-      [host]    = {.name="host"    , .size=4 , .info="Transmit command to host."},
-      [cat]     = {.name="cat"     , .size=3 , .info="Show on the stdout"},
-      [ls]      = {.name="ls"      , .size=2 , .info="Show directory under"},
-      [mmtest]  = {.name="mmtest"  , .size=6 , .info="Report Memory Management test"},
-};	
+SHELL_COMMAND(hello, hello_command, "Show 'Hello! how are you?'");
+
+void echo_command(int argc, char *argv[])
+{
+	int i;
 
+	for(i=1;i<argc;i++){
+		if(i>1)
+			Puts(" ");
+		Puts(argv[i]);
+	}
+	Print_nextLine();
+}
 
+SHELL_COMMAND(echo, echo_command, "Show your input");
 
-void mmtest_command(char *str)
+void ps_command(int argc, char *argv[])
+{
+	char title[]="Name\t\t\b\bState\t\b\b\bPriority\t\bStack\t\bNum";
+	char catch[256];
+
+	Puts(title);
+	vTaskList(catch);
+	Print(catch);
+}
+
+SHELL_COMMAND(ps, ps_command, "Report current processes");
+
+void mmtest_command(int argc, char *argv[])
 {
 	char set=1;
 	char mm_str[MAX_SERIAL_STR];	
@@ -63,7 +64,7 @@ void mmtest_command(char *str)
 		set=0;
 		Read_Input(mm_str,MAX_SERIAL_STR);
 		if(!strncmp(mm_str,"Y", 1) || !strncmp(mm_str,"y", 1)){
-			mmtest_fio_function(str);
+			mmtest_fio_function(argv[0]);
 		}
 		else if(!strncmp(mm_str,"N", 1) || !strncmp(mm_str,"n", 1)){
 			Print("Leave mmtest!");
@@ -75,121 +76,276 @@ void mmtest_command(char *str)
 	}
 }
 
-void cat_command(char *str)
+SHELL_COMMAND(mmtest, mmtest_command, "Report Memory Management test");
+
+void cat_command(int argc, char *argv[])
 {
-    char i;
-    char c[20];
-    char path[20]="/romfs/";
-    char buff[100],tmp[7];
-    buff[0]='\0';
-    int count;
-    if(strlen(str)==CMD[cat].size){
-		Print("Please input: cat <file> (EX:cat test.txt)");
-	}
-	else if(str[CMD[cat].size]==' '){
-		for(i=CMD[cat].size+1 ; i<strlen(str) ; i++){
-				tmp[i- (CMD[cat].size+1) ]=str[i];
-			}			
-			strcat(path,tmp);
-    		        int fd = fs_open(path, 0, O_RDONLY);
-			if(fd<0){
-      			        Print("No such this file.");
-       			 }
-       			 else{
-          		        count = fio_read(fd, buff, sizeof(buff));
-				char buff2[count-1];
-				for(i=0;i<count-1;i++)
-				buff2[i]=buff[i];
-				Print(buff2);
- 			} 
+	char path[64];
+	int i, fd;
+
+	if(argc<2){
+		/* Copies its input when it is not the terminal. */
+		if(fio_stdin()==0)
+			Print("Please input: cat <file> (EX:cat test.txt)");
+		else if(fio_copy(fio_stdin(), fio_stdout->fd) < 0)
+			Print("Read error.");
+		return;
 	}
-	else{
-		Print("Error!");
+	for(i=1;i<argc;i++){
+		/* Bare names are in romfs. */
+		strlcpy(path, argv[i][0]=='/' ? "" : "/romfs/", sizeof(path));
+		strlcat(path, argv[i], sizeof(path));
+		fd = fs_open(path, 0, O_RDONLY);
+		if(fd<0){
+			Print("No such this file.");
+			continue;
+		}
+		/* Streamed to the serial port whatever the size, romfs
+		 * files straight from flash. */
+		fio_fflush(fio_stdout);
+		if(fio_copy(fd, fio_stdout->fd) < 0)
+			Print("Read error.");
+		else if(fio_stdout->fd==1)
+			Puts("\r");
+		fio_close(fd);
 	}
+}
+
+SHELL_COMMAND(cat, cat_command, "Show on the stdout");
 
+void grep_command(int argc, char *argv[])
+{
+	char line[MAX_SERIAL_STR];
+	size_t len;
+	char *p;
+
+	if(argc!=2 || fio_stdin()==0){
+		Print("Please input: <command> | grep <text>");
+		return;
+	}
+	len=strlen(argv[1]);
+	while(fio_getline(fio_stdin(), line, sizeof(line))>=0){
+		for(p=line;*p;p++){
+			if(!strncmp(p, argv[1], len)){
+				Print(line);
+				break;
+			}
+		}
+	}
 }
 
-void ls_command(char *str)
+SHELL_COMMAND(grep, grep_command, "Show the input lines holding a text");
+
+void ls_command(int argc, char *argv[])
 {
     char ls_buff[128];
     int fileNum;
     ls_buff[0]='\0';
-    fileNum=getAllFileName("/romfs/",ls_buff);
+    fileNum=getAllFileName("/romfs/",ls_buff,sizeof(ls_buff));
     Print(ls_buff);
 }
 
-void host_command(char *str)
+SHELL_COMMAND(ls, ls_command, "Show directory under");
+
+void host_command(int argc, char *argv[])
 {
-	char host_tmp[strlen(str)];
-	char i=0;
-	if(strlen(str)==CMD[host].size){
+	char cmd[MAX_SERIAL_STR];
+	int i;
+
+	if(argc<2){
 		Print("Please input: host <command>");
+		return;
 	}
-	else if(str[CMD[host].size]==' '){
-		for(i=CMD[host].size+1;i<strlen(str);i++){
-				host_tmp[i- (CMD[host].size+1) ]=str[i];
-			}
-			host_system(host_tmp, strlen(host_tmp));
-			Print("OK! You have transmitted the command to semihost.");
-	}
-	else{
-		Print("Error!");
+	cmd[0]='\0';
+	for(i=1;i<argc;i++){
+		if(i>1)
+			strlcat(cmd, " ", sizeof(cmd));
+		strlcat(cmd, argv[i], sizeof(cmd));
 	}
+	host_system(cmd, strlen(cmd));
+	Print("OK! You have transmitted the command to semihost.");
 }
 
-void ShellTask_Command(char *str)
-{		
-	char tmp[20];
-	char i;
-	char c[40];
-	if(!strncmp(str,"hello", 5)) {           
-		Print("Hello! how are you?");
+SHELL_COMMAND(host, host_command, "Transmit command to host.");
+
+/* Room for tasks started while top runs. */
+#define TOP_SPARE_TASKS 4
+#define TOP_PERIOD_MS 1000
+
+void top_command(int argc, char *argv[])
+{
+	static const char state_char[] = { [eRunning] = 'X', [eReady] = 'R',
+		[eBlocked] = 'B', [eSuspended] = 'S', [eDeleted] = 'D' };
+	xTaskStatusType *status, *now, *last, *swap;
+	unsigned portBASE_TYPE i, j, size, count, last_count = 0;
+	unsigned long total, last_total = 0, elapsed, run, switches;
+	char key;
+
+	/* Two snapshots, taken from the heap only while top runs. */
+	size = uxTaskGetNumberOfTasks() + TOP_SPARE_TASKS;
+	status = pvPortMalloc(2 * size * sizeof(*status));
+	if (!status) {
+		Print("Out of memory.");
+		return;
 	}
-	else if(!strncmp(str,"echo", 4)){
-		if(strlen(str)==4){
-			Print_nextLine();
-		}
-		if(str[4]==' '){
-			for(i=5;i<strlen(str);i++){
-				tmp[i-5]=str[i];
-			}
-			Print(tmp);
+	now = status;
+	last = status + size;
+
+	/* Redraw every period with the usage since the previous one, until a
+	 * key is pressed. */
+	do {
+		count = uxTaskGetSystemState(now, size, &total);
+		if (!count) {
+			Print("Too many tasks.");
+			break;
 		}
-	}
-	else if(!strncmp(str,"ps",2)){
-		char title[]="Name\t\t\b\bState\t\b\b\bPriority\t\bStack\t\bNum";
-		Puts(title);
-		char catch[50];
-		vTaskList(catch);
-		Print(catch);
-	}
-	else if(!strncmp(str,"help", 4)) {           
-		sprintf(c,"You can use %d command in the freeRTOS",Command_Number);
-		Print(c);
-		Print_nextLine();
-		for(i=0;i<Command_Number;i++){
-		Puts(CMD[i].name);
-		Puts("\t-- ");
-		Puts(CMD[i].info);
+		elapsed = total - last_total;
+
 		Print_nextLine();
+		Print("Name\t\tState\tPrio\tCPU\tSwitches\tStack");
+		for (i = 0; i < count; i++) {
+			run = now[i].ulRunTimeCounter;
+			switches = now[i].ulSwitchCount;
+			for (j = 0; j < last_count; j++) {
+				if (last[j].xTaskNumber == now[i].xTaskNumber) {
+					run -= last[j].ulRunTimeCounter;
+					switches -= last[j].ulSwitchCount;
+					break;
+				}
+			}
+			printf("%s\t\t%c\t%u\t%u%c\t%u\t\t%u\n\r",
+			       now[i].pcTaskName, state_char[now[i].eCurrentState],
+			       (unsigned) now[i].uxCurrentPriority,
+			       (unsigned) (elapsed >= 100 ? run / (elapsed / 100) : 0), '%',
+			       (unsigned) switches, now[i].usStackHighWaterMark);
 		}
+		Print("Press any key to leave top.");
+
+		swap = last;
+		last = now;
+		now = swap;
+		last_count = count;
+		last_total = total;
+	} while (!receive_bytes(&key, 1, TOP_PERIOD_MS / portTICK_RATE_MS));
+
+	vPortFree(status);
+}
+
+SHELL_COMMAND(top, top_command, "Show CPU usage per task");
+
+void trace_command(int argc, char *argv[])
+{
+	if (argc < 2) {
+		trace_status();
 	}
-	else if(!strncmp(str,"host",4)){
-		host_command(str);
+	else if (!strcmp(argv[1], "start")) {
+		trace_start();
 	}
-	else if(!strncmp(str,"cat",3)){
-		cat_command(str);
+	else if (!strcmp(argv[1], "stop")) {
+		trace_stop();
 	}
-	else if(!strncmp(str,"ls",2)){
-		ls_command(str);
+	else if (!strcmp(argv[1], "clear")) {
+		trace_clear();
 	}
-	else if(!strncmp(str,"mmtest",6)){
-		mmtest_command(str);
+	else if (!strcmp(argv[1], "dump")) {
+		if (trace_dump(argc > 2 ? argv[2] : "trace.bin"))
+			Print("Trace dump failed.");
+		else
+			Print("OK! Trace written to the host.");
 	}
-	else{
-		Print("Command not found, please input 'help'");
+	else {
+		Print("Please input: trace [start|stop|clear|dump [file]]");
 	}
 }
+
+SHELL_COMMAND(trace, trace_command, "Control the trace recorder");
+
+#define HEAP_MAX_TASKS 8
+
+#ifdef configEXTERNAL_SRAM_BASE
+/* Spread the heap over the external SRAM as well, see FreeRTOSConfig.h. */
+static const xHeapRegionType heap_regions[] = {
+	{ configEXTERNAL_SRAM_BASE, configEXTERNAL_SRAM_SIZE, pdFALSE },
+	{ NULL, 0, pdFALSE }
+};
+#define HEAP_TOTAL_SIZE (configTOTAL_HEAP_SIZE + configEXTERNAL_SRAM_SIZE)
+#else
+#define HEAP_TOTAL_SIZE configTOTAL_HEAP_SIZE
+#endif
+
+static const char *heap_task_name(const void *handle, xTaskStatusType *status, unsigned portBASE_TYPE count)
+{
+	unsigned portBASE_TYPE i;
+
+	if (!handle)
+		return "(main)";
+	for (i = 0; i < count; i++)
+		if (status[i].xHandle == handle)
+			return (const char *) status[i].pcTaskName;
+	return "(deleted)";
+}
+
+static const char *heap_hex(const void *p, char *buf)
+{
+	snprintf(buf, 2 + sizeof(p) * 2 + 1, "0x%0*lx", (int) sizeof(p) * 2, (unsigned long) p);
+	return buf;
+}
+
+static void heap_owner(const char *name, struct heapstat_owner *owner)
+{
+	if (owner->blocks)
+		printf("%s\t%s%u\t%u\n\r", name, strlen(name) < 8 ? "\t" : "",
+		       (unsigned) owner->bytes, owner->blocks);
+}
+
+void heap_command(int argc, char *argv[])
+{
+	static const char *bucket_name[portHEAP_HISTOGRAM_BUCKETS] = {
+		"<32", "<64", "<128", "<256", "<512", "<1K", "<2K", "more" };
+	xHeapStatsType stats;
+	struct heapstat snap;
+	xTaskStatusType status[HEAP_MAX_TASKS];
+	unsigned portBASE_TYPE count;
+	char addr[2 + sizeof(void *) * 2 + 1];
+	int i;
+
+	count = uxTaskGetSystemState(status, HEAP_MAX_TASKS, NULL);
+	vPortGetHeapStats(&stats);
+	heapstat_snapshot(&snap);
+
+	printf("Heap %u bytes: %u free, %u at the lowest, %u refused\n\r",
+	       (unsigned) HEAP_TOTAL_SIZE, (unsigned) stats.xAvailableHeapSpaceInBytes,
+	       (unsigned) stats.xMinimumEverFreeBytesRemaining, (unsigned) snap.failed);
+	printf("%u allocations, %u frees\n\r",
+	       (unsigned) stats.xNumberOfSuccessfulAllocations,
+	       (unsigned) stats.xNumberOfSuccessfulFrees);
+	printf("%u free blocks, largest %u, smallest %u\n\r",
+	       (unsigned) stats.xNumberOfFreeBlocks,
+	       (unsigned) stats.xSizeOfLargestFreeBlockInBytes,
+	       (unsigned) stats.xSizeOfSmallestFreeBlockInBytes);
+	for (i = 0; i < portHEAP_HISTOGRAM_BUCKETS; i++)
+		printf("%s\t", bucket_name[i]);
+	Print_nextLine();
+	for (i = 0; i < portHEAP_HISTOGRAM_BUCKETS; i++)
+		printf("%u\t", (unsigned) stats.xFreeBlockHistogram[i]);
+	Print_nextLine();
+
+	Print_nextLine();
+	Print("Task\t\tBytes\tBlocks");
+	for (i = 0; i < configHEAPSTAT_TASKS; i++)
+		heap_owner(heap_task_name(snap.tasks[i].owner, status, count), &snap.tasks[i]);
+	heap_owner("(other)", &snap.tasks[configHEAPSTAT_TASKS]);
+
+	Print_nextLine();
+	Print("Caller\t\tBytes\tBlocks");
+	for (i = 0; i < configHEAPSTAT_CALLERS; i++)
+		heap_owner(heap_hex(snap.callers[i].owner, addr), &snap.callers[i]);
+	heap_owner("(other)", &snap.callers[configHEAPSTAT_CALLERS]);
+	heap_owner("(untracked)", &snap.untracked);
+}
+
+SHELL_COMMAND(heap, heap_command, "Report heap usage and owners");
+
 void Shell()
 {
 	char str[MAX_SERIAL_STR];
@@ -197,22 +353,31 @@ void Shell()
 	char newLine[] = "\n\r";
 	while (1)
     {
-        fio_write(1, pos, strlen(pos));
+        Puts(pos);
 	Read_Input(str,MAX_SERIAL_STR);
 	/*This is my shell command*/
-	ShellTask_Command(str);
+	shell_run(str);
     }
 }
 
 
+/* The shell is always there, give it its memory at link time. */
+static portSTACK_TYPE shell_stack[512];
+static xStaticTaskType shell_tcb;
+
 int main()
 {
+#ifdef configEXTERNAL_SRAM_BASE
+	vPortDefineHeapRegions(heap_regions);
+#endif
+	trace_init();
 	Init_Serial();
 
 	/* Create a task to receive char from the RS232 port. */
-	xTaskCreate(Shell,
-	            (signed portCHAR *) "Shell",
-	            512 /* stack size */, NULL, tskIDLE_PRIORITY + 5, NULL);
+	xTaskCreateStatic(Shell,
+	                  (signed portCHAR *) "Shell",
+	                  sizeof(shell_stack) / sizeof(shell_stack[0]), NULL,
+	                  tskIDLE_PRIORITY + 5, shell_stack, &shell_tcb);
 	
 	/* Start running the tasks. */
 	vTaskStartScheduler();
@@ -8,6 +8,8 @@
 #include <dirent.h>
 #include <string.h>
 
+#include "romfs.h"
+
 #define hash_init 5381
 
 uint32_t hash_djb2(const uint8_t * str, uint32_t hash) {
@@ -20,18 +22,35 @@ uint32_t hash_djb2(const uint8_t * str, uint32_t hash) {
 }
 
 void usage(const char * binname) {
-    printf("Usage: %s [-d <dir>] [outfile]\n", binname);
+    printf("Usage: %s [-z] [-d <dir>] [outfile]\n", binname);
     exit(-1);
 }
 
-void processdir(DIR * dirp, const char * curpath, FILE * outfile, const char * prefix) {
+struct entry_t {
+    char fullpath[1024];
+    char name[256];
+    uint32_t hash;
+    uint32_t size;
+    uint32_t offset;
+    uint8_t * packed;       /* the LZSS stream, when compressed */
+    uint32_t packed_size;
+};
+
+static struct entry_t * entries = NULL;
+static uint32_t nentries = 0, maxentries = 0;
+static int compress = 0;
+
+void write_le32(FILE * outfile, uint32_t v) {
+    uint8_t b[4] = { v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, (v >> 24) & 0xff };
+    fwrite(b, 1, 4, outfile);
+}
+
+void processdir(DIR * dirp, const char * curpath, const char * prefix) {
     char fullpath[1024];
-    char buf[16 * 1024];
     struct dirent * ent;
     DIR * rec_dirp;
     uint32_t cur_hash = hash_djb2((const uint8_t *) curpath, hash_init);
-    uint32_t size, w, hash, fileNameLength, headerLength;
-    uint8_t b;
+    struct entry_t * e;
     FILE * infile;
 
     while ((ent = readdir(dirp))) {
@@ -50,49 +69,191 @@ void processdir(DIR * dirp, const char * curpath, FILE * outfile, const char * p
                 continue;
             strcat(fullpath, "/");
             rec_dirp = opendir(fullpath);
-            processdir(rec_dirp, fullpath + strlen(prefix) + 1, outfile, prefix);
+            processdir(rec_dirp, fullpath + strlen(prefix) + 1, prefix);
             closedir(rec_dirp);
         } else {
-            hash = hash_djb2((const uint8_t *) ent->d_name, cur_hash);
-            fileNameLength = strlen(ent->d_name);
-            headerLength = fileNameLength + fileNameLength%4;
+            if (nentries == maxentries) {
+                maxentries = maxentries ? maxentries * 2 : 64;
+                entries = realloc(entries, maxentries * sizeof(struct entry_t));
+                if (!entries) {
+                    perror("allocating entries");
+                    exit(-1);
+                }
+            }
+            e = entries + nentries++;
+            strcpy(e->fullpath, fullpath);
+            strcpy(e->name, ent->d_name);
+            e->packed = NULL;
+            e->hash = hash_djb2((const uint8_t *) ent->d_name, cur_hash);
             infile = fopen(fullpath, "rb");
             if (!infile) {
                 perror("opening input file");
                 exit(-1);
             }
-            b = (hash >>  0) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (hash >>  8) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (hash >> 16) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (hash >> 24) & 0xff; fwrite(&b, 1, 1, outfile);
-
-            b = (headerLength >>  0) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (headerLength >>  8) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (headerLength >> 16) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (headerLength >> 24) & 0xff; fwrite(&b, 1, 1, outfile);
-
-            fwrite(ent->d_name, 1, fileNameLength, outfile);
-            b=0;
-            while(headerLength-- > fileNameLength)
-            {
-                fwrite(&b, 1, 1, outfile);
-            }
-
             fseek(infile, 0, SEEK_END);
-            size = ftell(infile);
-            fseek(infile, 0, SEEK_SET);
-            b = (size >>  0) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (size >>  8) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (size >> 16) & 0xff; fwrite(&b, 1, 1, outfile);
-            b = (size >> 24) & 0xff; fwrite(&b, 1, 1, outfile);
-            while (size) {
-                w = size > 16 * 1024 ? 16 * 1024 : size;
-                fread(buf, 1, w, infile);
-                fwrite(buf, 1, w, outfile);
-                size -= w;
+            e->size = ftell(infile);
+            fclose(infile);
+        }
+    }
+}
+
+/* Greedy LZSS in the format described in romfs.h.  out needs room for
+ * size + size / 8 + 1 bytes. */
+uint32_t lz_compress(const uint8_t * in, uint32_t size, uint8_t * out) {
+    uint32_t pos = 0, o = 0, control = 0, best_len, best_dist, len, dist;
+    int bit = 8;
+
+    while (pos < size) {
+        if (bit == 8) {
+            control = o++;
+            out[control] = 0;
+            bit = 0;
+        }
+
+        best_len = 0;
+        best_dist = 0;
+        for (dist = 1; dist <= ROMFS_LZ_WINDOW && dist <= pos; dist++) {
+            for (len = 0; len < ROMFS_LZ_MAX_MATCH && pos + len < size; len++)
+                if (in[pos + len] != in[pos + len - dist])
+                    break;
+            if (len > best_len) {
+                best_len = len;
+                best_dist = dist;
             }
+        }
+
+        if (best_len >= ROMFS_LZ_MIN_MATCH) {
+            out[o++] = best_dist - 1;
+            out[o++] = best_len - ROMFS_LZ_MIN_MATCH;
+            pos += best_len;
+        } else {
+            out[control] |= 1 << bit;
+            out[o++] = in[pos++];
+        }
+        bit++;
+    }
+
+    return o;
+}
+
+/* Packs the files that get smaller for it, the rest stay raw. */
+void compressfiles(void) {
+    uint8_t * raw;
+    FILE * infile;
+    uint32_t i;
+
+    for (i = 0; i < nentries; i++) {
+        if (entries[i].size < ROMFS_LZ_MIN_FILE)
+            continue;
+
+        raw = malloc(entries[i].size);
+        entries[i].packed = malloc(entries[i].size + entries[i].size / 8 + 1);
+        if (!raw || !entries[i].packed) {
+            perror("allocating compression buffers");
+            exit(-1);
+        }
+        infile = fopen(entries[i].fullpath, "rb");
+        if (!infile || fread(raw, 1, entries[i].size, infile) != entries[i].size) {
+            perror("reading input file");
+            exit(-1);
+        }
+        fclose(infile);
+
+        entries[i].packed_size = lz_compress(raw, entries[i].size, entries[i].packed);
+        free(raw);
+
+        /* Not worth the original size word and the decoding. */
+        if (entries[i].packed_size + 4 >= entries[i].size) {
+            free(entries[i].packed);
+            entries[i].packed = NULL;
+        }
+    }
+}
+
+/* The size as recorded in the image, with ROMFS_COMPRESSED when packed. */
+uint32_t stored_size(const struct entry_t * e) {
+    return e->packed ? (e->packed_size + 4) | ROMFS_COMPRESSED : e->size;
+}
+
+int compare_hash(const void * a, const void * b) {
+    uint32_t ha = (*(const struct entry_t **) a)->hash;
+    uint32_t hb = (*(const struct entry_t **) b)->hash;
+
+    return ha < hb ? -1 : ha > hb;
+}
+
+void writeimage(FILE * outfile) {
+    char buf[16 * 1024];
+    struct entry_t ** index;
+    uint32_t i, offset, size, w, fileNameLength, headerLength;
+    uint8_t b;
+    FILE * infile;
+
+    /* File records follow the header and index in directory order. */
+    offset = 8 + nentries * sizeof(struct romfs_index_t);
+    for (i = 0; i < nentries; i++) {
+        fileNameLength = strlen(entries[i].name);
+        headerLength = fileNameLength + fileNameLength%4;
+        entries[i].offset = offset + 8 + headerLength + 4;
+        offset = entries[i].offset + (stored_size(entries + i) & ROMFS_SIZE_MASK);
+    }
+
+    index = malloc(nentries * sizeof(struct entry_t *));
+    if (!index && nentries) {
+        perror("allocating index");
+        exit(-1);
+    }
+    for (i = 0; i < nentries; i++)
+        index[i] = entries + i;
+    qsort(index, nentries, sizeof(struct entry_t *), compare_hash);
+
+    write_le32(outfile, ROMFS_INDEX_MAGIC);
+    write_le32(outfile, nentries);
+    for (i = 0; i < nentries; i++) {
+        if (i && index[i]->hash == index[i - 1]->hash) {
+            fprintf(stderr, "hash collision between %s and %s\n", index[i - 1]->fullpath, index[i]->fullpath);
+            exit(-1);
+        }
+        write_le32(outfile, index[i]->hash);
+        write_le32(outfile, index[i]->offset);
+        write_le32(outfile, stored_size(index[i]));
+    }
+    free(index);
+
+    for (i = 0; i < nentries; i++) {
+        fileNameLength = strlen(entries[i].name);
+        headerLength = fileNameLength + fileNameLength%4;
+        infile = fopen(entries[i].fullpath, "rb");
+        if (!infile) {
+            perror("opening input file");
+            exit(-1);
+        }
+        write_le32(outfile, entries[i].hash);
+        write_le32(outfile, headerLength);
+
+        fwrite(entries[i].name, 1, fileNameLength, outfile);
+        b=0;
+        while(headerLength-- > fileNameLength)
+        {
+            fwrite(&b, 1, 1, outfile);
+        }
+
+        write_le32(outfile, stored_size(entries + i));
+        if (entries[i].packed) {
+            write_le32(outfile, entries[i].size);
+            fwrite(entries[i].packed, 1, entries[i].packed_size, outfile);
             fclose(infile);
+            continue;
         }
+
+        size = entries[i].size;
+        while (size) {
+            w = size > 16 * 1024 ? 16 * 1024 : size;
+            fread(buf, 1, w, infile);
+            fwrite(buf, 1, w, outfile);
+            size -= w;
+        }
+        fclose(infile);
     }
 }
 
@@ -112,6 +273,9 @@ int main(int argc, char ** argv) {
             case 'd':
                 dirname = *argv++;
                 break;
+            case 'z':
+                compress = 1;
+                break;
             default:
                 usage(binname);
                 break;
@@ -139,7 +303,10 @@ int main(int argc, char ** argv) {
         exit(-1);
     }
 
-    processdir(dirp, "", outfile, dirname);
+    processdir(dirp, "", dirname);
+    if (compress)
+        compressfiles();
+    writeimage(outfile);
     fwrite(&z, 1, 8, outfile);
     if (outname)
         fclose(outfile);
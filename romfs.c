@@ -7,10 +7,25 @@
 #include "romfs.h"
 #include "osdebug.h"
 #include "hash-djb2.h"
+#include "string-util.h"
+
+/* Decoder state of an open compressed file, see romfs.h for the format. */
+struct romfs_lz_t {
+    const uint8_t * src;        /* next byte of the stream */
+    uint32_t out;               /* bytes decoded so far */
+    uint16_t match_len;         /* bytes of the current match left to copy */
+    uint16_t match_dist;
+    uint16_t pos;               /* where the next byte goes in the window */
+    uint8_t control;            /* control bits not used yet */
+    uint8_t bits;
+    uint8_t window[ROMFS_LZ_WINDOW];
+};
 
 struct romfs_fds_t {
-    const uint8_t * file;
+    const uint8_t * file;       /* the data, past the original size if compressed */
+    uint32_t size;              /* the original size */
     uint32_t cursor;
+    struct romfs_lz_t * lz;     /* NULL for files stored as they are */
 };
 
 static struct romfs_fds_t romfs_fds[MAX_FDS];
@@ -19,15 +34,70 @@ static uint32_t get_unaligned(const uint8_t * d) {
     return ((uint32_t) d[0]) | ((uint32_t) (d[1] << 8)) | ((uint32_t) (d[2] << 16)) | ((uint32_t) (d[3] << 24));
 }
 
+static void romfs_lz_reset(struct romfs_lz_t * lz, const uint8_t * stream) {
+    lz->src = stream;
+    lz->out = 0;
+    lz->match_len = 0;
+    lz->pos = 0;
+    lz->bits = 0;
+}
+
+/* Decodes the next byte.  The caller keeps count of the original size, the
+ * stream has no end marker. */
+static uint8_t romfs_lz_getc(struct romfs_lz_t * lz) {
+    uint8_t c;
+
+    if (!lz->match_len) {
+        if (!lz->bits) {
+            lz->control = *lz->src++;
+            lz->bits = 8;
+        }
+        lz->bits--;
+        if (lz->control & 1) {
+            lz->control >>= 1;
+            c = *lz->src++;
+            lz->window[lz->pos] = c;
+            lz->pos = (lz->pos + 1) & (ROMFS_LZ_WINDOW - 1);
+            lz->out++;
+            return c;
+        }
+        lz->control >>= 1;
+        lz->match_dist = lz->src[0] + 1;
+        lz->match_len = lz->src[1] + ROMFS_LZ_MIN_MATCH;
+        lz->src += 2;
+    }
+
+    c = lz->window[(lz->pos - lz->match_dist) & (ROMFS_LZ_WINDOW - 1)];
+    lz->window[lz->pos] = c;
+    lz->pos = (lz->pos + 1) & (ROMFS_LZ_WINDOW - 1);
+    lz->match_len--;
+    lz->out++;
+    return c;
+}
+
+/* Seeks only move the cursor; reads decode forward to it, from the start of
+ * the stream again when it went backwards. */
+static void romfs_lz_read(struct romfs_fds_t * f, uint8_t * buf, size_t count) {
+    struct romfs_lz_t * lz = f->lz;
+
+    if (f->cursor < lz->out)
+        romfs_lz_reset(lz, f->file);
+    while (lz->out < f->cursor)
+        romfs_lz_getc(lz);
+    while (count--)
+        *buf++ = romfs_lz_getc(lz);
+}
+
 static ssize_t romfs_read(void * opaque, void * buf, size_t count) {
     struct romfs_fds_t * f = (struct romfs_fds_t *) opaque;
-    const uint8_t * size_p = f->file - 4;
-    uint32_t size = get_unaligned(size_p);
 
-    if ((f->cursor + count) > size)
-        count = size - f->cursor;
+    if ((f->cursor + count) > f->size)
+        count = f->size - f->cursor;
 
-    memcpy(buf, f->file + f->cursor, count);
+    if (f->lz)
+        romfs_lz_read(f, (uint8_t *) buf, count);
+    else
+        memcpy(buf, f->file + f->cursor, count);
     f->cursor += count;
 
     return count;
@@ -35,8 +105,7 @@ static ssize_t romfs_read(void * opaque, void * buf, size_t count) {
 
 static off_t romfs_seek(void * opaque, off_t offset, int whence) {
     struct romfs_fds_t * f = (struct romfs_fds_t *) opaque;
-    const uint8_t * size_p = f->file - 4;
-    uint32_t size = get_unaligned(size_p);
+    uint32_t size = f->size;
     uint32_t origin;
 
     switch (whence) {
@@ -65,15 +134,58 @@ static off_t romfs_seek(void * opaque, off_t offset, int whence) {
     return offset;
 }
 
+/* The image is in memory mapped flash, hand out the file in place. */
+static int romfs_mmap(void * opaque, const void ** ptr, size_t * len) {
+    struct romfs_fds_t * f = (struct romfs_fds_t *) opaque;
+
+    *ptr = f->file;
+    *len = f->size;
+
+    return 0;
+}
+
+static int romfs_close(void * opaque) {
+    struct romfs_fds_t * f = (struct romfs_fds_t *) opaque;
+
+    vPortFree(f->lz);
+    f->lz = NULL;
+
+    return 0;
+}
+
+static const uint8_t * romfs_get_file_by_index(const uint8_t * romfs, uint32_t h, uint32_t * len) {
+    const struct romfs_index_t * index = (const struct romfs_index_t *) (romfs + 8);
+    uint32_t lo = 0, hi = ((const uint32_t *) romfs)[1], mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) >> 1;
+        if (index[mid].hash < h) {
+            lo = mid + 1;
+        } else if (index[mid].hash > h) {
+            hi = mid;
+        } else {
+            if (len) {
+                *len = index[mid].size;
+            }
+            return romfs + index[mid].offset;
+        }
+    }
+
+    return NULL;
+}
+
 const uint8_t * romfs_get_file_by_hash(const uint8_t * romfs, uint32_t h, uint32_t * len) {
     const uint8_t * meta;
+
+    if (get_unaligned(romfs) == ROMFS_INDEX_MAGIC)
+        return romfs_get_file_by_index(romfs, h, len);
 
     /*
         file information: |hash|size of name|name of file|size of data|data|
         get_unaligned(meta + 4): the size used to store name, get_unaligned(meta + 8 + get_unaligned(meta + 4)): the size used to store data,
         12: hash code + information of length used to store the name + information of size used to store the data
     */
-    for (meta = romfs; get_unaligned(meta) && get_unaligned(meta + 4); meta += get_unaligned(meta + 4) + get_unaligned(meta + 8 + get_unaligned(meta + 4)) + 12) {
+    for (meta = romfs; get_unaligned(meta) && get_unaligned(meta + 4); meta += get_unaligned(meta + 4) + (get_unaligned(meta + 8 + get_unaligned(meta + 4)) & ROMFS_SIZE_MASK) + 12) {
         if (get_unaligned(meta) == h) {
             if (len) {
                 *len = get_unaligned(meta + 8 + get_unaligned(meta + 4));
@@ -85,40 +197,69 @@ const uint8_t * romfs_get_file_by_hash(const uint8_t * romfs, uint32_t h, uint32
     return NULL;
 }
 
-const uint8_t * getNextFileName(const uint8_t * romfs, char * buff)
+/* Skip the index of an indexed image, returning the first file record. */
+const uint8_t * romfs_get_entries(const uint8_t * romfs) {
+    if (get_unaligned(romfs) == ROMFS_INDEX_MAGIC)
+        return romfs + 8 + get_unaligned(romfs + 4) * sizeof(struct romfs_index_t);
+
+    return romfs;
+}
+
+/* Appends the name and a tab to buff, cutting it short at size. */
+const uint8_t * getNextFileName(const uint8_t * romfs, char * buff, size_t size)
 {
     if(!(get_unaligned(romfs) && get_unaligned(romfs + 4)))
         return NULL;
 
     uint32_t i;
     uint32_t fileNameLength = get_unaligned(romfs+4);
-    romfs+=8;
-    char ch[]={'0','\0'};
-    while(fileNameLength--)
-    {
-        if(*romfs==0)
-            break;
-        ch[0]=*romfs++;
-        strcat(buff,ch);
-    }
-    strcat(buff,"\t");
-    return romfs+get_unaligned(romfs)+4;
+    const uint8_t * name = romfs + 8;
+    size_t len = strlen(buff);
+    for(i = 0; i < fileNameLength && name[i] && len + 1 < size; i++)
+        buff[len++] = name[i];
+    buff[len] = '\0';
+    strlcat(buff, "\t", size);
+    /* The name is zero padded, so skip the whole stored length. */
+    romfs = name + fileNameLength;
+    return romfs+(get_unaligned(romfs) & ROMFS_SIZE_MASK)+4;
 }
 
 static int romfs_open(void * opaque, const char * path, int flags, int mode) {
     uint32_t h = hash_djb2((const uint8_t *) path, -1);
     const uint8_t * romfs = (const uint8_t *) opaque;
     const uint8_t * file;
+    struct romfs_lz_t * lz = NULL;
+    uint32_t len;
     int r = -1;
 
-    file = romfs_get_file_by_hash(romfs, h, NULL);
+    /* Read only, a redirection into romfs fails here. */
+    if (flags & (O_WRONLY | O_RDWR | O_CREAT | O_TRUNC | O_APPEND))
+        return -1;
+
+    file = romfs_get_file_by_hash(romfs, h, &len);
 
     if (file) {
-        r = fio_open(romfs_read, NULL, romfs_seek, NULL, NULL);
+        /* Compressed files get a decoder and window of their own. */
+        if (len & ROMFS_COMPRESSED) {
+            lz = pvPortMalloc(sizeof(struct romfs_lz_t));
+            if (!lz)
+                return -1;
+            len = get_unaligned(file);
+            file += 4;
+            romfs_lz_reset(lz, file);
+        }
+
+        r = fio_open(romfs_read, NULL, romfs_seek, romfs_close, NULL);
         if (r > 0) {
             romfs_fds[r].file = file;
+            romfs_fds[r].size = len;
             romfs_fds[r].cursor = 0;
+            romfs_fds[r].lz = lz;
             fio_set_opaque(r, romfs_fds + r);
+            if (!lz)
+                fio_set_mmap(r, romfs_mmap);
+        } else {
+            vPortFree(lz);
         }
     }
     return r;
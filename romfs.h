@@ -2,10 +2,47 @@
 #define __ROMFS_H__
 
 #include <stdint.h>
+#include <stddef.h>
+
+/*
+    Indexed image layout, as emitted by mkromfs:
+        |magic|count|index entry * count|file record ...|0|0|
+    index entry: |hash|offset of data|size of data|, sorted by hash
+    file record: |hash|size of name|name of file|size of data|data|
+    All header and index words are little endian and 4-byte aligned so the
+    index can be binary-searched in place. Images without the magic word are
+    the legacy layout (file records only) and are scanned linearly.
+
+    Files packed by "mkromfs -z" have ROMFS_COMPRESSED set in both size
+    words, which then give the stored size. Their data is
+        |original size|LZSS stream|
+    The stream is groups of a control byte followed by up to 8 items, one per
+    control bit starting from the least significant: a set bit is a literal
+    byte, a clear bit a match of two bytes |distance - 1|length - 3| copying
+    from the last ROMFS_LZ_WINDOW bytes of output. The stream ends with the
+    last byte of the original file.
+*/
+#define ROMFS_INDEX_MAGIC 0x58444e49 /* "INDX" */
+
+#define ROMFS_COMPRESSED  0x80000000
+#define ROMFS_SIZE_MASK   0x7fffffff
+
+#define ROMFS_LZ_WINDOW    256
+#define ROMFS_LZ_MIN_MATCH 3
+#define ROMFS_LZ_MAX_MATCH (ROMFS_LZ_MIN_MATCH + 255)
+
+/* Smaller files are always stored as they are, they are read in place. */
+#define ROMFS_LZ_MIN_FILE  64
+
+struct romfs_index_t {
+    uint32_t hash;
+    uint32_t offset;
+    uint32_t size;
+};
 
 void register_romfs(const char * mountpoint, const uint8_t * romfs);
 const uint8_t * romfs_get_file_by_hash(const uint8_t * romfs, uint32_t h, uint32_t * len);
-const uint8_t * getNextFileName(const uint8_t * romfs, char* buff);
+const uint8_t * romfs_get_entries(const uint8_t * romfs);
+const uint8_t * getNextFileName(const uint8_t * romfs, char* buff, size_t size);
 
 #endif
-
@@ -0,0 +1,371 @@
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "fio.h"
+#include "fio-stream.h"
+#include "fio-pipe.h"
+#include "filesystem.h"
+#include "shell.h"
+#include "hash-djb2.h"
+
+#define SHELL_MASK (SHELL_TABLE_SIZE - 1)
+#define SHELL_STAGE_STACK (configMINIMAL_STACK_SIZE * 3)
+#define SHELL_STREAM_BUF_SIZE 64
+
+#if SHELL_TABLE_SIZE & SHELL_MASK
+#error SHELL_TABLE_SIZE must be a power of two
+#endif
+
+struct shell_slot {
+    uint32_t hash;
+    const char * name;      /* NULL for a free slot */
+    shell_handler_t handler;
+    const char * help;
+};
+
+extern const struct shell_command __start_shell_commands[];
+extern const struct shell_command __stop_shell_commands[];
+
+static struct shell_slot shell_table[SHELL_TABLE_SIZE];
+/* Slot numbers in registration order, for help. */
+static uint8_t shell_order[SHELL_MAX_COMMANDS];
+static int shell_count;
+static int shell_ready;
+
+/* The target does not run constructors, so the linked in commands are
+ * entered on first use. */
+static void shell_init() {
+    const struct shell_command * cmd;
+
+    shell_ready = 1;
+    for (cmd = __start_shell_commands; cmd < __stop_shell_commands; cmd++)
+        shell_register(cmd->name, cmd->handler, cmd->help);
+}
+
+static struct shell_slot * shell_lookup(const char * name, uint32_t hash) {
+    int i;
+
+    for (i = hash & SHELL_MASK; shell_table[i].name; i = (i + 1) & SHELL_MASK)
+        if (shell_table[i].hash == hash && !strcmp(shell_table[i].name, name))
+            return &shell_table[i];
+
+    return NULL;
+}
+
+int shell_register(const char * name, shell_handler_t handler, const char * help) {
+    uint32_t hash = hash_djb2((const uint8_t *) name, -1);
+    int i;
+
+    if (!shell_ready)
+        shell_init();
+
+    if (shell_count == SHELL_MAX_COMMANDS || shell_lookup(name, hash))
+        return -1;
+
+    /* The table is never full, a free slot turns up. */
+    for (i = hash & SHELL_MASK; shell_table[i].name; i = (i + 1) & SHELL_MASK);
+    shell_table[i].hash = hash;
+    shell_table[i].name = name;
+    shell_table[i].handler = handler;
+    shell_table[i].help = help;
+    shell_order[shell_count++] = i;
+
+    return 0;
+}
+
+/* Operators come back from shell_parse() as these very strings, so a
+ * quoted "|" stays a word. */
+static char shell_op_pipe[] = "|";
+static char shell_op_in[] = "<";
+static char shell_op_out[] = ">";
+static char shell_op_append[] = ">>";
+
+static int shell_is_op(const char * s) {
+    return s == shell_op_pipe || s == shell_op_in || s == shell_op_out || s == shell_op_append;
+}
+
+/* Splits line into words and operators, copying the words to words, which
+ * needs room for twice the line.  Blanks separate words, | < > and >> end
+ * them, double quotes group them.  Returns the number of arguments or -1
+ * when there are too many. */
+static int shell_parse(const char * line, char * words, char * argv[]) {
+    int argc = 0;
+
+    for (;;) {
+        while (*line == ' ' || *line == '\t')
+            line++;
+        if (!*line)
+            break;
+        if (argc == SHELL_MAX_ARGS)
+            return -1;
+
+        if (*line == '|') {
+            argv[argc++] = shell_op_pipe;
+            line++;
+        } else if (*line == '<') {
+            argv[argc++] = shell_op_in;
+            line++;
+        } else if (*line == '>') {
+            argv[argc++] = line[1] == '>' ? shell_op_append : shell_op_out;
+            line += line[1] == '>' ? 2 : 1;
+        } else {
+            argv[argc++] = words;
+            while (*line && !strchr(" \t|<>", *line)) {
+                if (*line == '"') {
+                    for (line++; *line && *line != '"'; )
+                        *words++ = *line++;
+                    if (*line)
+                        line++;
+                } else {
+                    *words++ = *line++;
+                }
+            }
+            *words++ = '\0';
+        }
+    }
+
+    argv[argc] = NULL;
+    return argc;
+}
+
+/* Pipelines -------------------------------------------------------------*/
+
+/* One command of a pipeline with its standard streams.  All but the last
+ * run in tasks of their own, the last in the shell task. */
+struct shell_stage {
+    struct shell_slot * cmd;
+    int argc;
+    char ** argv;
+    const char * in_path;       /* redirections, NULL for none */
+    const char * out_path;
+    int append;
+    struct fio_stdio io;
+    int out;                    /* fd behind io.out */
+    struct fio_stream stream;
+    char buf[SHELL_STREAM_BUF_SIZE];
+    int running;                /* in a task that gives done at the end */
+    xSemaphoreHandle done;
+    xStaticSemaphoreType done_buffer;
+};
+
+/* Taken from the heap for the length of one line only. */
+struct shell_pipeline {
+    struct shell_stage stages[SHELL_MAX_STAGES];
+    struct fio_pipe pipes[SHELL_MAX_STAGES - 1];
+    char pipe_buf[SHELL_MAX_STAGES - 1][SHELL_PIPE_SIZE];
+};
+
+static void shell_stage_close(struct shell_stage * st) {
+    if (st->io.in > 0)
+        fio_close(st->io.in);
+    if (st->out > 1)
+        fio_close(st->out);
+    st->io.in = 0;
+    st->out = 1;
+}
+
+/* Closing the ends on the way out lets the neighbours finish: the next
+ * command reads the end of its input, the previous one fails to write. */
+static void shell_stage_exec(struct shell_stage * st) {
+    fio_set_stdio(&st->io);
+    st->cmd->handler(st->argc, st->argv);
+    fio_fflush(fio_stdout);
+    fio_set_stdio(NULL);
+    shell_stage_close(st);
+}
+
+static void shell_stage_task(void * param) {
+    struct shell_stage * st = (struct shell_stage *) param;
+
+    shell_stage_exec(st);
+    xSemaphoreGive(st->done);
+    vTaskDelete(NULL);
+}
+
+/* Splits argv at the pipes into pl->stages, taking the redirections out of
+ * the argument lists.  Returns the number of stages or -1. */
+static int shell_split(struct shell_pipeline * pl, int argc, char * argv[]) {
+    struct shell_stage * st;
+    int n = 0, r = 0, w = 0, last;
+    char * tok;
+
+    do {
+        if (n == SHELL_MAX_STAGES) {
+            Print("Too many commands in the pipeline.");
+            return -1;
+        }
+        st = &pl->stages[n++];
+        st->argv = &argv[w];
+
+        /* Words move down over the redirections, w never passes r. */
+        while (r < argc && argv[r] != shell_op_pipe) {
+            tok = argv[r++];
+            if (tok == shell_op_in || tok == shell_op_out || tok == shell_op_append) {
+                if (r == argc || shell_is_op(argv[r])) {
+                    Print("Syntax error.");
+                    return -1;
+                }
+                if (tok == shell_op_in) {
+                    st->in_path = argv[r++];
+                } else {
+                    st->out_path = argv[r++];
+                    st->append = tok == shell_op_append;
+                }
+            } else {
+                argv[w++] = tok;
+            }
+        }
+        st->argc = &argv[w] - st->argv;
+
+        last = r == argc;
+        if (!last)
+            r++;
+        argv[w++] = NULL;
+
+        if (!st->argc) {
+            Print("Syntax error.");
+            return -1;
+        }
+        if ((st->in_path && n > 1) || (st->out_path && !last)) {
+            Print("Only the first command can read a file, only the last write one.");
+            return -1;
+        }
+        st->cmd = shell_lookup(st->argv[0], hash_djb2((const uint8_t *) st->argv[0], -1));
+        if (!st->cmd) {
+            Print("Command not found, please input 'help'");
+            return -1;
+        }
+    } while (!last);
+
+    return n;
+}
+
+/* Opens the files and pipes between the stages. */
+static int shell_connect(struct shell_pipeline * pl, int n) {
+    struct shell_stage * first = &pl->stages[0], * st = &pl->stages[n - 1];
+    int i, fd[2];
+
+    for (i = 0; i < n; i++) {
+        pl->stages[i].io.in = 0;
+        pl->stages[i].out = 1;
+    }
+
+    if (first->in_path) {
+        first->io.in = fs_open(first->in_path, O_RDONLY, 0);
+        if (first->io.in < 0) {
+            first->io.in = 0;
+            printf("Cannot read %s.\n\r", first->in_path);
+            return -1;
+        }
+    }
+    if (st->out_path) {
+        st->out = fs_open(st->out_path, O_WRONLY | O_CREAT | (st->append ? O_APPEND : O_TRUNC), 0);
+        if (st->out < 0) {
+            st->out = 1;
+            printf("Cannot write %s.\n\r", st->out_path);
+            return -1;
+        }
+    }
+    for (i = 0; i < n - 1; i++) {
+        if (fio_pipe(&pl->pipes[i], pl->pipe_buf[i], SHELL_PIPE_SIZE, fd)) {
+            Print("Out of file descriptors.");
+            return -1;
+        }
+        pl->stages[i].out = fd[1];
+        pl->stages[i + 1].io.in = fd[0];
+    }
+
+    /* Output to the terminal keeps the shared line buffered stream. */
+    for (i = 0; i < n; i++) {
+        st = &pl->stages[i];
+        st->io.out = NULL;
+        if (st->out != 1) {
+            fio_fdopen(&st->stream, st->out, st->buf, sizeof(st->buf), FIO_FBF);
+            st->io.out = &st->stream;
+        }
+    }
+
+    return 0;
+}
+
+static void shell_pipeline(int argc, char * argv[]) {
+    struct shell_pipeline * pl = pvPortMalloc(sizeof(*pl));
+    struct shell_stage * st;
+    int n, i;
+
+    if (!pl) {
+        Print("Out of memory.");
+        return;
+    }
+    memset(pl, 0, sizeof(*pl));
+
+    n = shell_split(pl, argc, argv);
+    if (n < 0 || shell_connect(pl, n) < 0) {
+        for (i = 0; i < (n < 0 ? 0 : n); i++)
+            shell_stage_close(&pl->stages[i]);
+        vPortFree(pl);
+        return;
+    }
+
+    /* Producers at the shell's priority, they run while it waits on them. */
+    for (i = 0; i < n - 1; i++) {
+        st = &pl->stages[i];
+        st->done = xSemaphoreCreateBinaryStatic(&st->done_buffer);
+        st->running = xTaskCreate(shell_stage_task, (const signed char *) st->argv[0],
+                                  SHELL_STAGE_STACK, st, uxTaskPriorityGet(NULL), NULL) == pdPASS;
+        if (!st->running) {
+            Print("Out of memory.");
+            shell_stage_close(st);
+        }
+    }
+    shell_stage_exec(&pl->stages[n - 1]);
+
+    for (i = 0; i < n - 1; i++)
+        if (pl->stages[i].running)
+            xSemaphoreTake(pl->stages[i].done, portMAX_DELAY);
+    vPortFree(pl);
+}
+
+void shell_run(char * line) {
+    char words[2 * strlen(line) + 1];
+    char * argv[SHELL_MAX_ARGS + 1];
+    struct shell_slot * cmd;
+    int argc, i;
+
+    if (!shell_ready)
+        shell_init();
+
+    argc = shell_parse(line, words, argv);
+    if (argc < 0) {
+        Print("Too many arguments.");
+        return;
+    }
+    if (!argc)
+        return;
+
+    for (i = 0; i < argc; i++)
+        if (shell_is_op(argv[i])) {
+            shell_pipeline(argc, argv);
+            return;
+        }
+
+    cmd = shell_lookup(argv[0], hash_djb2((const uint8_t *) argv[0], -1));
+    if (!cmd) {
+        Print("Command not found, please input 'help'");
+        return;
+    }
+    cmd->handler(argc, argv);
+}
+
+static void help_command(int argc, char * argv[]) {
+    int i;
+
+    printf("You can use %d command in the freeRTOS\n\r", shell_count);
+    Print_nextLine();
+    for (i = 0; i < shell_count; i++)
+        printf("%s\t-- %s\n\r", shell_table[shell_order[i]].name,
+               shell_table[shell_order[i]].help);
+}
+
+SHELL_COMMAND(help, help_command, "Show command list.");
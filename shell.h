@@ -0,0 +1,51 @@
+#ifndef __SHELL_H__
+#define __SHELL_H__
+
+#include <stdint.h>
+
+/* Shell command dispatch.  Commands live in a hash table keyed by the djb2
+ * hash of their name: a line is split into argv once, then finding the
+ * handler is one hash and, on a hit, one string compare, however many
+ * commands there are.  Names match whole words only.
+ *
+ * Commands are registered at run time with shell_register(), or at link
+ * time from any file with SHELL_COMMAND(), which needs no list to edit:
+ *
+ *     static void hello_command(int argc, char *argv[]) { ... }
+ *     SHELL_COMMAND(hello, hello_command, "Say hello");
+ *
+ * A line may also be a pipeline with redirections, "ps | grep Shell > f".
+ * Each command then gets its standard streams through fio_stdin() and
+ * fio_stdout (see fio-stream.h), which Print() and printf() follow: the
+ * first reads a file with "<", the last writes one with ">" or appends
+ * with ">>", and "|" connects neighbours through a bounded pipe.  All but
+ * the last command run in tasks of their own. */
+
+#define SHELL_TABLE_SIZE 32     /* hash slots, a power of two */
+#define SHELL_MAX_COMMANDS (SHELL_TABLE_SIZE * 3 / 4)
+#define SHELL_MAX_ARGS 16       /* words and operators on a line */
+#define SHELL_MAX_STAGES 3      /* commands in a pipeline */
+#define SHELL_PIPE_SIZE 64      /* bytes in each pipe, a power of two */
+
+typedef void (*shell_handler_t)(int argc, char *argv[]);
+
+struct shell_command {
+    const char * name;
+    shell_handler_t handler;
+    const char * help;
+};
+
+/* Placed in their own section, the linker collects them between
+ * __start_shell_commands and __stop_shell_commands (see main.ld). */
+#define SHELL_COMMAND(cmd, fn, text) \
+    static const struct shell_command shell_command_##cmd \
+    __attribute__((section("shell_commands"), used, aligned(sizeof(void *)))) = \
+    { .name = #cmd, .handler = fn, .help = text }
+
+/* Returns -1 when the name is taken or the table is full. */
+int shell_register(const char * name, shell_handler_t handler, const char * help);
+
+/* Splits line and runs the command or pipeline on it. */
+void shell_run(char * line);
+
+#endif
@@ -4,7 +4,13 @@
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_usart.h"
 #include "stm32f10x_exti.h"
+#include "stm32f10x_dma.h"
+#include "stm32f10x_tim.h"
 #include "misc.h"
+#include "FreeRTOS.h"
+
+/* Upper half of the run time counter, incremented on each TIM2 overflow. */
+static volatile unsigned long run_time_overflows = 0;
 
 void init_led(void)
 {
@@ -105,9 +111,11 @@ void enable_rs232_interrupts(void)
 {
     NVIC_InitTypeDef NVIC_InitStructure;
 
-    /* Enable transmit and receive interrupts for the USART2. */
+    /* Enable receive and idle line interrupts for the USART2, transmit
+     * interrupts are enabled on demand. */
     USART_ITConfig(USART2, USART_IT_TXE, DISABLE);
     USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
+    USART_ITConfig(USART2, USART_IT_IDLE, ENABLE);
 
     /* Enable the USART2 IRQ in the NVIC module (so that the USART2 interrupt
      * handler is enabled). */
@@ -117,8 +125,99 @@ void enable_rs232_interrupts(void)
     NVIC_Init(&NVIC_InitStructure);
 }
 
+void init_rs232_dma(void)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    /* USART2 TX requests are served by DMA1 channel 7.  The memory address
+     * and transfer length are filled in for each transfer. */
+    DMA_DeInit(DMA1_Channel7);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &USART2->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = 0;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel7, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel7, DMA_IT_TC, ENABLE);
+
+    USART_DMACmd(USART2, USART_DMAReq_Tx, ENABLE);
+
+    /* The transfer complete handler calls FreeRTOS, so keep it at the lowest
+     * priority (below configMAX_SYSCALL_INTERRUPT_PRIORITY). */
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel7_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x0F;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x0F;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
 void enable_rs232(void)
 {
     /* Enable the RS232 port. */
     USART_Cmd(USART2, ENABLE);
 }
+
+void init_run_time_timer(void)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+
+    /* TIM2 is clocked at the core clock (APB1 is divided, so its timer clock
+     * is doubled back), count up over the full 16-bit range. */
+    TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
+    TIM_TimeBaseStructure.TIM_Prescaler = SystemCoreClock / configRUN_TIME_COUNTER_HZ - 1;
+    TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseStructure.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
+
+    TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+    TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
+
+    /* The handler does not call FreeRTOS, any priority will do. */
+    NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x0F;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x0F;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    TIM_Cmd(TIM2, ENABLE);
+}
+
+void TIM2_IRQHandler(void)
+{
+    if (TIM_GetITStatus(TIM2, TIM_IT_Update) != RESET) {
+        TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+        run_time_overflows++;
+    }
+}
+
+unsigned long get_run_time_timer(void)
+{
+    unsigned long high, low, pending;
+
+    /* Retry if the overflow interrupt ran in between.  When interrupts are
+     * masked (the kernel calls this from the context switch) the overflow
+     * can only be seen pending, and counts if the counter has just wrapped. */
+    do {
+        high = run_time_overflows;
+        low = TIM2->CNT;
+        pending = TIM2->SR & TIM_IT_Update;
+    } while (high != run_time_overflows);
+
+    if (pending && low < 0x8000)
+        high++;
+
+    return (high << 16) | low;
+}
@@ -21,6 +21,16 @@ void init_rs232(void);
 
 void enable_rs232_interrupts(void);
 
+/* Configures DMA1 channel 7 to feed the USART2 transmitter and enables its
+ * transfer complete interrupt. */
+void init_rs232_dma(void);
+
 void enable_rs232(void);
 
+/* Starts TIM2 as a free running counter at configRUN_TIME_COUNTER_HZ for the
+ * FreeRTOS run time statistics.  The 16-bit counter is extended to 32 bits by
+ * counting its overflows in the TIM2 update interrupt. */
+void init_run_time_timer(void);
+unsigned long get_run_time_timer(void);
+
 #endif /* __STM32_P103_H */
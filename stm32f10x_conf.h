@@ -31,7 +31,7 @@
 /* #include "stm32f10x_crc.h" */
 /* #include "stm32f10x_dac.h" */
 /* #include "stm32f10x_dbgmcu.h" */
-/* #include "stm32f10x_dma.h" */
+#include "stm32f10x_dma.h"
 /* #include "stm32f10x_exti.h" */
 /* #include "stm32f10x_flash.h" */
 /* #include "stm32f10x_fsmc.h" */
@@ -43,7 +43,7 @@
 /* #include "stm32f10x_rtc.h" */
 /* #include "stm32f10x_sdio.h" */
 /* #include "stm32f10x_spi.h" */
-/* #include "stm32f10x_tim.h" */
+#include "stm32f10x_tim.h"
 #include "stm32f10x_usart.h"
 /* #include "stm32f10x_wwdg.h" */
 /* #include "misc.h" */ /* High level functions for NVIC and SysTick (add-on to CMSIS functions) */
@@ -9,17 +9,23 @@
 #include "queue.h"
 #include "semphr.h"
 
+#include "string-util.h"
+
 #define ALIGN (sizeof(size_t))
 #define ONES ((size_t)-1/UCHAR_MAX)                                                                      
 #define HIGHS (ONES * (UCHAR_MAX/2+1))
 #define HASZERO(x) ((x)-ONES & ~(x) & HIGHS)
 
 #define SS (sizeof(size_t))
+
+/* Word accesses to memory of any type. */
+typedef size_t __attribute__((__may_alias__)) word_t;
+
 void *memset(void *dest, int c, size_t n)
 {
 	unsigned char *s = dest;
 	c = (unsigned char)c;
-	for (; ((uintptr_t)s & ALIGN) && n; n--) *s++ = c;
+	for (; ((uintptr_t)s & (ALIGN-1)) && n; n--) *s++ = c;
 	if (n) {
 		size_t *w, k = ONES * c;
 		for (w = (void *)s; n>=SS; n-=SS, w++) *w = k;
@@ -28,85 +34,257 @@ void *memset(void *dest, int c, size_t n)
 	return dest;
 }
 
+/* Copies forwards only, memmove() relies on that when dest < src. */
 void *memcpy(void *dest, const void *src, size_t n)
 {
-	void *ret = dest;
-	
-	//Cut rear
-	uint8_t *dst8 = dest;
-	const uint8_t *src8 = src;
-	switch (n % 4) {
-		case 3 : *dst8++ = *src8++;
-		case 2 : *dst8++ = *src8++;
-		case 1 : *dst8++ = *src8++;
-		case 0 : ;
+	unsigned char *d = dest;
+	const unsigned char *s = src;
+	word_t *wd;
+	const word_t *ws;
+
+	if (n >= 2*SS) {
+		/* Stores are the expensive side, align the destination. */
+		for (; (uintptr_t)d & (ALIGN-1); n--) *d++ = *s++;
+		wd = (void *)d;
+
+		if (!((uintptr_t)s & (ALIGN-1))) {
+			ws = (const void *)s;
+#if defined(__arm__)
+			/* 32 bytes per LDM/STM pair, one bus burst each way.
+			 * r7 is the Thumb frame pointer and stays out of the list. */
+			for (; n >= 8*SS; n -= 8*SS)
+				__asm volatile ("ldmia %0!, {r3-r6, r8-r10, r12}\n\t"
+				                "stmia %1!, {r3-r6, r8-r10, r12}"
+				                : "+r" (ws), "+r" (wd) :
+				                : "r3", "r4", "r5", "r6", "r8", "r9", "r10", "r12", "memory");
+#else
+			for (; n >= 4*SS; n -= 4*SS, ws += 4, wd += 4) {
+				wd[0] = ws[0]; wd[1] = ws[1];
+				wd[2] = ws[2]; wd[3] = ws[3];
+			}
+#endif
+			for (; n >= SS; n -= SS) *wd++ = *ws++;
+			s = (const void *)ws;
+		} else {
+			/* Source misaligned: read aligned words and merge each
+			 * neighbouring pair (little endian).  Every word read holds
+			 * at least one byte of the source, so this never touches
+			 * memory past its end. */
+			unsigned shift = 8 * ((uintptr_t)s & (ALIGN-1));
+			size_t lo, hi;
+
+			ws = (const void *)((uintptr_t)s & ~(uintptr_t)(ALIGN-1));
+			for (lo = *ws++; n >= SS; n -= SS, lo = hi) {
+				hi = *ws++;
+				*wd++ = lo >> shift | hi << (8*SS - shift);
+			}
+			s = (const unsigned char *)ws - SS + shift/8;
+		}
+		d = (void *)wd;
 	}
-	
-	//stm32 data bus width
-	uint32_t *dst32 = (void *)dst8;
-	const uint32_t *src32 = (void *)src8;
-	n = n / 4;
-	while (n--) {
-		*dst32++ = *src32++;
+
+	for (; n; n--) *d++ = *s++;
+	return dest;
+}
+
+void *memmove(void *dest, const void *src, size_t n)
+{
+	unsigned char *d = dest;
+	const unsigned char *s = src;
+
+	if (d == s)
+		return dest;
+	if (d < s || d >= s + n)
+		return memcpy(dest, src, n);
+
+	/* dest overlaps the end of src, copy backwards. */
+	d += n;
+	s += n;
+	if (!(((uintptr_t)d ^ (uintptr_t)s) & (ALIGN-1))) {
+		word_t *wd;
+		const word_t *ws;
+
+		for (; ((uintptr_t)d & (ALIGN-1)) && n; n--) *--d = *--s;
+		wd = (void *)d;
+		ws = (const void *)s;
+		for (; n >= SS; n -= SS) *--wd = *--ws;
+		d = (void *)wd;
+		s = (const void *)ws;
 	}
-	
-	return ret;
+	for (; n; n--) *--d = *--s;
+	return dest;
 }
 
+int memcmp(const void *vl, const void *vr, size_t n)
+{
+	const unsigned char *l = vl, *r = vr;
+
+	if (!(((uintptr_t)l ^ (uintptr_t)r) & (ALIGN-1))) {
+		const word_t *wl, *wr;
+
+		for (; ((uintptr_t)l & (ALIGN-1)) && n; n--, l++, r++)
+			if (*l != *r)
+				return *l - *r;
+		/* Skip the equal words, the bytes below find the difference. */
+		wl = (const void *)l;
+		wr = (const void *)r;
+		for (; n >= SS && *wl == *wr; n -= SS) wl++, wr++;
+		l = (const void *)wl;
+		r = (const void *)wr;
+	}
+	for (; n; n--, l++, r++)
+		if (*l != *r)
+			return *l - *r;
+	return 0;
+}
+
+/* The str* routines below read whole aligned words.  An aligned word never
+ * crosses a page or region boundary, so reading past the terminator inside
+ * the last one is harmless.  Where source and destination differ in
+ * alignment they fall back to bytes: the words could only be stored with
+ * unaligned accesses. */
+
 char *strchr(const char *s, int c)
 {
-	for (; *s && *s != c; s++);
-	return (*s == c) ? (char *)s : NULL;
+	const word_t *w;
+	size_t k;
+
+	c = (unsigned char)c;
+	if (!c) return (char *)s + strlen(s);
+
+	for (; (uintptr_t)s & (ALIGN-1); s++)
+		if (!*s || *(unsigned char *)s == c) goto found;
+	k = ONES * c;
+	for (w = (const void *)s; !HASZERO(*w) && !HASZERO(*w^k); w++);
+	for (s = (const void *)w; *s && *(unsigned char *)s != c; s++);
+found:
+	return *(unsigned char *)s == c ? (char *)s : NULL;
 }
 
 char *strcpy(char *dest, const char *src)
 {
-	const unsigned char *s = src;
-	unsigned char *d = dest;
+	const unsigned char *s = (const void *)src;
+	unsigned char *d = (void *)dest;
+
+	if (!(((uintptr_t)s ^ (uintptr_t)d) & (ALIGN-1))) {
+		word_t *wd;
+		const word_t *ws;
+
+		for (; (uintptr_t)s & (ALIGN-1); s++, d++)
+			if (!(*d = *s)) return dest;
+		wd = (void *)d;
+		ws = (const void *)s;
+		for (; !HASZERO(*ws); *wd++ = *ws++);
+		d = (void *)wd;
+		s = (const void *)ws;
+	}
 	while ((*d++ = *s++));
 	return dest;
 }
 
+/* Pads dest with zeros up to n, as the standard requires. */
 char *strncpy(char *dest, const char *src, size_t n)
 {
-	const unsigned char *s = src;
-	unsigned char *d = dest;
-	while (n-- && (*d++ = *s++));
+	const unsigned char *s = (const void *)src;
+	unsigned char *d = (void *)dest;
+
+	if (!(((uintptr_t)s ^ (uintptr_t)d) & (ALIGN-1))) {
+		word_t *wd;
+		const word_t *ws;
+
+		for (; ((uintptr_t)s & (ALIGN-1)) && n && (*d = *s); n--, s++, d++);
+		if (!n || !*s) goto tail;
+		wd = (void *)d;
+		ws = (const void *)s;
+		for (; n >= SS && !HASZERO(*ws); n -= SS) *wd++ = *ws++;
+		d = (void *)wd;
+		s = (const void *)ws;
+	}
+	for (; n && (*d = *s); n--, s++, d++);
+tail:
+	memset(d, 0, n);
 	return dest;
 }
 
 size_t strlen(const char *s)
 {
-        const char *a = s;
-        const size_t *w;
-        for (; (uintptr_t) s % ALIGN; s++)
-                if (!*s) return (s - a);
+	const char *a = s;
+	const word_t *w;
+	for (; (uintptr_t)s & (ALIGN-1); s++)
+		if (!*s) return (s - a);
 	for (w = (const void *) s; !HASZERO(*w); w++);
-	for (s = (const void *) w; *s; s++);	
+	for (s = (const void *) w; *s; s++);
 	return (s - a);
 }
 
+int strcmp(const char *s1, const char *s2)
+{
+	const unsigned char *l = (const void *)s1, *r = (const void *)s2;
+
+	if (!(((uintptr_t)l ^ (uintptr_t)r) & (ALIGN-1))) {
+		const word_t *wl, *wr;
+
+		for (; (uintptr_t)l & (ALIGN-1); l++, r++)
+			if (*l != *r || !*l) return *l - *r;
+		wl = (const void *)l;
+		wr = (const void *)r;
+		for (; *wl == *wr && !HASZERO(*wl); wl++, wr++);
+		l = (const void *)wl;
+		r = (const void *)wr;
+	}
+	for (; *l == *r && *l; l++, r++);
+	return *l - *r;
+}
+
 int strncmp(const char *s1, const char *s2, size_t n)
 {
-    for ( ; n > 0; s1++, s2++, --n)
-	if (*s1 != *s2)
-	    return ((*(unsigned char *)s1 < *(unsigned char *)s2) ? -1 : +1);
-	else if (*s1 == '\0')
-	    return 0;
-    return 0;
+	const unsigned char *l = (const void *)s1, *r = (const void *)s2;
+
+	if (!(((uintptr_t)l ^ (uintptr_t)r) & (ALIGN-1))) {
+		const word_t *wl, *wr;
+
+		for (; ((uintptr_t)l & (ALIGN-1)) && n; n--, l++, r++)
+			if (*l != *r || !*l) return *l - *r;
+		wl = (const void *)l;
+		wr = (const void *)r;
+		for (; n >= SS && *wl == *wr && !HASZERO(*wl); n -= SS) wl++, wr++;
+		l = (const void *)wl;
+		r = (const void *)wr;
+	}
+	for (; n && *l == *r && *l; n--, l++, r++);
+	return n ? *l - *r : 0;
+}
+
+char *strcat(char *dest, const char *src)
+{
+	strcpy(dest + strlen(dest), src);
+	return dest;
 }
 
-char * strcat ( char * destination, const char * source )
+/* BSD style bounded copies: dest is always terminated when size is not
+ * zero, and the length of the string they tried to build is returned, so
+ * truncation is "ret >= size". */
+size_t strlcpy(char *dest, const char *src, size_t size)
 {
-    int dLength = strlen(destination);
-    int sLength = strlen(source);
-    int i;
-    for (i = 0; i<sLength; i++)
-    {
-        destination[i+dLength]=source[i];
-    }
-    destination[dLength+sLength]='\0';
-    return destination;
+	size_t len = strlen(src);
+
+	if (size) {
+		size_t n = len < size ? len : size - 1;
+
+		memcpy(dest, src, n);
+		dest[n] = 0;
+	}
+	return len;
+}
+
+size_t strlcat(char *dest, const char *src, size_t size)
+{
+	size_t len = 0;
+
+	for (; len < size && dest[len]; len++);
+	if (len == size)
+		return len + strlen(src);
+	return len + strlcpy(dest + len, src, size - len);
 }
 
 /*Ref andy79923*/
@@ -1,7 +1,21 @@
+#ifndef __STRING_UTIL_H__
+#define __STRING_UTIL_H__
+
 #include <stddef.h>
-+void *memset(void *dest, int c, size_t n);
-+void *memcpy(void *dest, const void *src, size_t n);
-+char *strchr(const char *s, int c);
-+char *strcpy(char *dest, const char *src);
-+char *strncpy(char *dest, const char *src, size_t n);
-+size_t strlen(char *str);
+
+void *memset(void *dest, int c, size_t n);
+void *memcpy(void *dest, const void *src, size_t n);
+void *memmove(void *dest, const void *src, size_t n);
+int memcmp(const void *vl, const void *vr, size_t n);
+char *strchr(const char *s, int c);
+char *strcpy(char *dest, const char *src);
+char *strncpy(char *dest, const char *src, size_t n);
+size_t strlen(const char *s);
+int strcmp(const char *s1, const char *s2);
+int strncmp(const char *s1, const char *s2, size_t n);
+char *strcat(char *dest, const char *src);
+size_t strlcpy(char *dest, const char *src, size_t size);
+size_t strlcat(char *dest, const char *src, size_t size);
+char *itoa(int value, char *str);
+
+#endif
@@ -0,0 +1,285 @@
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "fio.h"
+#include "host.h"
+#include "trace.h"
+
+#define TRACE_MASK (configTRACE_RECORDER_EVENTS - 1)
+
+#if configTRACE_RECORDER_EVENTS & TRACE_MASK
+#error configTRACE_RECORDER_EVENTS must be a power of two
+#endif
+
+static struct trace_event trace_buf[configTRACE_RECORDER_EVENTS];
+static unsigned long trace_head;
+static volatile int trace_enabled;
+static uint8_t trace_current = TRACE_NO_TASK;
+static uint8_t trace_queues;
+static uint32_t trace_clock_hz;
+
+/* Clock and locking ------------------------------------------------------*/
+
+#if defined(__arm__)
+#include "stm32f10x.h"
+
+#define traceDEMCR         ((volatile unsigned long *) 0xE000EDFC)
+#define traceDWT_CTRL      ((volatile unsigned long *) 0xE0001000)
+#define traceDWT_CYCCNT    ((volatile unsigned long *) 0xE0001004)
+#define traceDEMCR_TRCENA  0x01000000
+#define traceDWT_CYCCNTENA 0x00000001
+
+/* Emulators may not model the DWT, use the run time stats timer then. */
+static int use_dwt = 0;
+
+static void trace_clock_init(void)
+{
+    unsigned long start;
+    volatile int i;
+
+    *traceDEMCR |= traceDEMCR_TRCENA;
+    *traceDWT_CTRL |= traceDWT_CYCCNTENA;
+
+    start = *traceDWT_CYCCNT;
+    for (i = 0; i < 100; i++);
+    use_dwt = *traceDWT_CYCCNT != start;
+    trace_clock_hz = use_dwt ? SystemCoreClock : configRUN_TIME_COUNTER_HZ;
+}
+
+static inline uint32_t trace_clock(void)
+{
+    return use_dwt ? *traceDWT_CYCCNT : get_run_time_timer();
+}
+
+/* Mask everything rather than use portSET_INTERRUPT_MASK_FROM_ISR(): the
+ * CM3 version unconditionally clears BASEPRI on the way out, which would
+ * break the critical sections most of the trace points sit in. */
+static inline unsigned long trace_lock(void)
+{
+    unsigned long primask;
+
+    __asm volatile ("mrs %0, primask\n"
+                    "cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+static inline void trace_unlock(unsigned long primask)
+{
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+static inline struct trace_event * trace_slot(void)
+{
+    return &trace_buf[trace_head++ & TRACE_MASK];
+}
+
+static inline uint8_t trace_exception_number(void)
+{
+    unsigned long ipsr;
+
+    __asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+    return ipsr & 0xFF;
+}
+#else
+#include <time.h>
+
+static void trace_clock_init(void)
+{
+    trace_clock_hz = 1000000;
+}
+
+static inline uint32_t trace_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+/* The simulator runs one task at a time and delivers its interrupts as
+ * signals to the running thread, so claiming the slot atomically is enough
+ * to keep an interrupt from sharing it. */
+static inline unsigned long trace_lock(void)
+{
+    return 0;
+}
+
+static inline void trace_unlock(unsigned long flags)
+{
+    (void) flags;
+}
+
+static inline struct trace_event * trace_slot(void)
+{
+    return &trace_buf[__sync_fetch_and_add(&trace_head, 1) & TRACE_MASK];
+}
+
+static inline uint8_t trace_exception_number(void)
+{
+    return 0;
+}
+#endif
+
+/* Recording --------------------------------------------------------------*/
+
+void trace_record(uint8_t type, uint8_t id, uint16_t arg)
+{
+    struct trace_event *ev;
+    unsigned long flags;
+
+    if (!trace_enabled)
+        return;
+
+    flags = trace_lock();
+    ev = trace_slot();
+    ev->timestamp = trace_clock();
+    ev->type = type;
+    ev->id = id;
+    ev->arg = arg;
+    trace_unlock(flags);
+}
+
+/* The kernel runs the switch hook on every tick and yield, only record
+ * those that actually change the running task. */
+void trace_task_switch(uint8_t id, uint16_t priority)
+{
+    if (id == trace_current)
+        return;
+
+    trace_current = id;
+    trace_record(TRACE_TASK_SWITCH, id, priority);
+}
+
+/* Queues have no number of their own, hand them out at creation. */
+uint8_t trace_queue_create(void)
+{
+    uint8_t queue = ++trace_queues;
+
+    trace_record(TRACE_QUEUE_CREATE, trace_current, queue);
+    return queue;
+}
+
+void trace_queue(uint8_t type, uint8_t queue)
+{
+    trace_record(type, trace_current, queue);
+}
+
+void trace_isr_enter(void)
+{
+    trace_record(TRACE_ISR_ENTER, trace_exception_number(), 0);
+}
+
+void trace_heap(uint8_t type, void *addr, uint32_t size)
+{
+    if (addr)
+        trace_record(type, trace_current, size > 0xFFFF ? 0xFFFF : size);
+}
+
+/* Control ----------------------------------------------------------------*/
+
+void trace_init(void)
+{
+    trace_clock_init();
+    trace_start();
+}
+
+void trace_start(void)
+{
+    trace_enabled = 1;
+}
+
+void trace_stop(void)
+{
+    trace_enabled = 0;
+}
+
+void trace_clear(void)
+{
+    int enabled = trace_enabled;
+
+    trace_enabled = 0;
+    trace_head = 0;
+    trace_enabled = enabled;
+}
+
+static int trace_write(int fd, const void *buf, size_t count)
+{
+    return count && host_write(fd, buf, count) ? -1 : 0;
+}
+
+/* Write the ring to a file on the host.  Recording is paused meanwhile so
+ * the dump does not trace itself. */
+int trace_dump(const char *path)
+{
+    struct trace_header header;
+    struct trace_task task;
+    xTaskStatusType *status;
+    unsigned long head, first, count, i;
+    int enabled = trace_enabled;
+    int fd, ret = 0;
+
+    trace_enabled = 0;
+
+    head = trace_head;
+    count = head < configTRACE_RECORDER_EVENTS ? head : configTRACE_RECORDER_EVENTS;
+    first = (head - count) & TRACE_MASK;
+
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.event_size = sizeof(struct trace_event);
+    header.clock_hz = trace_clock_hz;
+    header.events = count;
+    header.tasks = uxTaskGetNumberOfTasks();
+    header.heap_size = configTOTAL_HEAP_SIZE;
+    header.heap_free = xPortGetFreeHeapSize();
+
+    status = pvPortMalloc(header.tasks * sizeof(*status));
+    if (!status) {
+        trace_enabled = enabled;
+        return -1;
+    }
+    header.tasks = uxTaskGetSystemState(status, header.tasks, NULL);
+
+    fd = host_open(path, OPEN_WR_BIN);
+    if (fd < 0) {
+        vPortFree(status);
+        trace_enabled = enabled;
+        return -1;
+    }
+
+    ret |= trace_write(fd, &header, sizeof(header));
+    for (i = 0; i < header.tasks; i++) {
+        memset(&task, 0, sizeof(task));
+        task.id = status[i].xTaskNumber;
+        strncpy(task.name, (const char *) status[i].pcTaskName, TRACE_NAME_LEN - 1);
+        ret |= trace_write(fd, &task, sizeof(task));
+    }
+
+    /* The ring may wrap, write it in at most two runs. */
+    if (first + count > configTRACE_RECORDER_EVENTS) {
+        ret |= trace_write(fd, &trace_buf[first],
+                           (configTRACE_RECORDER_EVENTS - first) * sizeof(struct trace_event));
+        count -= configTRACE_RECORDER_EVENTS - first;
+        first = 0;
+    }
+    ret |= trace_write(fd, &trace_buf[first], count * sizeof(struct trace_event));
+
+    host_close(fd);
+    vPortFree(status);
+    trace_enabled = enabled;
+
+    return ret;
+}
+
+void trace_status(void)
+{
+    unsigned long head = trace_head;
+
+    printf("Trace %s, %d events recorded, %d in the ring of %d.\n\r",
+           trace_enabled ? "running" : "stopped", (int) head,
+           (int) (head < configTRACE_RECORDER_EVENTS ? head : configTRACE_RECORDER_EVENTS),
+           configTRACE_RECORDER_EVENTS);
+}
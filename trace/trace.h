@@ -0,0 +1,82 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+/* In-RAM binary trace recorder.
+ *
+ * The kernel trace macros (see FreeRTOSConfig.h) append fixed size,
+ * timestamped records to a ring in RAM; the oldest ones are overwritten
+ * when it wraps.  Recording an event is a few loads and stores with
+ * interrupts masked, there is no debugger round trip.  "trace dump <file>"
+ * writes the ring to the host over semihosting, trace/traceconv turns the
+ * file into a VCD or a Chrome trace (chrome://tracing, Perfetto). */
+
+/* This header is pulled in by FreeRTOSConfig.h and by the host side
+ * converter, keep it free of kernel includes. */
+#include <stdint.h>
+
+/* Ring size in events, a power of two. */
+#ifndef configTRACE_RECORDER_EVENTS
+#define configTRACE_RECORDER_EVENTS 128
+#endif
+
+#define TRACE_MAGIC   0x52545246    /* "FRTR" */
+#define TRACE_VERSION 1
+#define TRACE_NAME_LEN 16
+#define TRACE_NO_TASK  0xFF         /* id before the first task switch */
+
+enum trace_event_type {
+    TRACE_TASK_SWITCH = 1,      /* id: task in, arg: its priority */
+    TRACE_TASK_CREATE,          /* id: new task, arg: its priority */
+    TRACE_TASK_DELETE,          /* id: deleted task */
+    TRACE_QUEUE_CREATE,         /* arg: queue */
+    TRACE_QUEUE_SEND,           /* id: current task, arg: queue */
+    TRACE_QUEUE_RECEIVE,
+    TRACE_QUEUE_BLOCK_SEND,
+    TRACE_QUEUE_BLOCK_RECEIVE,
+    TRACE_ISR_ENTER,            /* id: exception number */
+    TRACE_MALLOC,               /* id: current task, arg: block size */
+    TRACE_FREE,
+};
+
+/* One record, 8 bytes. */
+struct trace_event {
+    uint32_t timestamp;         /* in trace clock ticks, see clock_hz */
+    uint8_t type;
+    uint8_t id;
+    uint16_t arg;
+};
+
+/* Dump file layout: header, task table, then the events oldest first.
+ * All fields are little endian. */
+struct trace_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t event_size;
+    uint32_t clock_hz;
+    uint32_t events;
+    uint32_t tasks;
+    uint32_t heap_size;
+    uint32_t heap_free;         /* at the time of the dump */
+};
+
+struct trace_task {
+    uint32_t id;
+    char name[TRACE_NAME_LEN];
+};
+
+void trace_init(void);
+void trace_start(void);
+void trace_stop(void);
+void trace_clear(void);
+int trace_dump(const char *path);
+void trace_status(void);
+
+/* Recording entry points, called through the kernel trace macros. */
+void trace_record(uint8_t type, uint8_t id, uint16_t arg);
+void trace_task_switch(uint8_t id, uint16_t priority);
+uint8_t trace_queue_create(void);
+void trace_queue(uint8_t type, uint8_t queue);
+void trace_isr_enter(void);
+void trace_heap(uint8_t type, void *addr, uint32_t size);
+
+#endif
@@ -0,0 +1,336 @@
+/* Host side converter for the files written by "trace dump": prints the
+ * recorded events as a VCD (one wire per task and interrupt, plus the heap
+ * usage) or as Chrome trace event JSON for chrome://tracing and Perfetto. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+struct change_t {
+    uint64_t time;
+    unsigned seq;
+    char text[40];
+};
+
+static struct trace_header header;
+static struct trace_task * tasks;
+static struct trace_event * events;
+static uint64_t * times;        /* event times in us from the first event */
+static uint32_t * heap_used;    /* heap usage after each event */
+static uint32_t heap_start;     /* and before the first one */
+
+void usage(const char * binname) {
+    printf("Usage: %s [-f vcd|json] <trace.bin> [outfile]\n", binname);
+    exit(-1);
+}
+
+static const char * task_name(unsigned id) {
+    static char name[TRACE_NAME_LEN + 8];
+    uint32_t i;
+
+    if (id == TRACE_NO_TASK)
+        return "startup";
+
+    for (i = 0; i < header.tasks; i++)
+        if (tasks[i].id == id)
+            return tasks[i].name;
+
+    /* Deleted before the dump. */
+    sprintf(name, "task%u", id);
+    return name;
+}
+
+static const char * isr_name(unsigned exception) {
+    static char name[16];
+
+    if (exception >= 16)
+        sprintf(name, "irq%u", exception - 16);
+    else
+        sprintf(name, "exception%u", exception);
+    return name;
+}
+
+static const char * queue_op(uint8_t type) {
+    switch (type) {
+    case TRACE_QUEUE_SEND:          return "send";
+    case TRACE_QUEUE_RECEIVE:       return "receive";
+    case TRACE_QUEUE_BLOCK_SEND:    return "block on send";
+    case TRACE_QUEUE_BLOCK_RECEIVE: return "block on receive";
+    default:                        return "create";
+    }
+}
+
+static void load(const char * path) {
+    FILE * f = fopen(path, "rb");
+    uint64_t t = 0;
+    uint32_t i, used;
+
+    if (!f) {
+        perror(path);
+        exit(-1);
+    }
+
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != TRACE_MAGIC) {
+        fprintf(stderr, "%s: not a trace dump\n", path);
+        exit(-1);
+    }
+    if (header.version != TRACE_VERSION || header.event_size != sizeof(struct trace_event)) {
+        fprintf(stderr, "%s: unsupported trace version %u\n", path, header.version);
+        exit(-1);
+    }
+
+    tasks = calloc(header.tasks, sizeof(*tasks));
+    events = calloc(header.events, sizeof(*events));
+    times = calloc(header.events, sizeof(*times));
+    heap_used = calloc(header.events, sizeof(*heap_used));
+    if (fread(tasks, sizeof(*tasks), header.tasks, f) != header.tasks ||
+        fread(events, sizeof(*events), header.events, f) != header.events) {
+        fprintf(stderr, "%s: truncated\n", path);
+        exit(-1);
+    }
+    fclose(f);
+
+    /* VCD identifiers end at a space. */
+    for (i = 0; i < header.tasks; i++) {
+        char * p;
+
+        tasks[i].name[TRACE_NAME_LEN - 1] = 0;
+        for (p = tasks[i].name; *p; p++)
+            if (*p == ' ')
+                *p = '_';
+    }
+
+    /* The timestamps are a wrapping 32 bit counter, accumulate the
+     * differences so long traces stay monotonic. */
+    for (i = 0; i < header.events; i++) {
+        if (i)
+            t += (uint32_t) (events[i].timestamp - events[i - 1].timestamp);
+        times[i] = t * 1000000 / header.clock_hz;
+    }
+
+    /* Only the usage at the time of the dump is known, walk back from it. */
+    used = header.heap_size - header.heap_free;
+    for (i = header.events; i--; ) {
+        heap_used[i] = used;
+        if (events[i].type == TRACE_MALLOC)
+            used -= events[i].arg;
+        else if (events[i].type == TRACE_FREE)
+            used += events[i].arg;
+    }
+    heap_start = used;
+}
+
+/* VCD --------------------------------------------------------------------*/
+
+static struct change_t * changes;
+static unsigned nchanges;
+
+static void change(uint64_t time, const char * text) {
+    changes = realloc(changes, (nchanges + 1) * sizeof(*changes));
+    changes[nchanges].time = time;
+    changes[nchanges].seq = nchanges;
+    strncpy(changes[nchanges].text, text, sizeof(changes[nchanges].text) - 1);
+    changes[nchanges].text[sizeof(changes[nchanges].text) - 1] = 0;
+    nchanges++;
+}
+
+static int change_cmp(const void * a, const void * b) {
+    const struct change_t * x = a, * y = b;
+
+    if (x->time != y->time)
+        return x->time < y->time ? -1 : 1;
+    return x->seq < y->seq ? -1 : 1;
+}
+
+static void heap_change(uint64_t time, uint32_t used) {
+    char text[40];
+    int bit;
+
+    text[0] = 'b';
+    for (bit = 0; bit < 32; bit++)
+        text[1 + bit] = used & (1u << (31 - bit)) ? '1' : '0';
+    strcpy(text + 33, " h");
+    change(time, text);
+}
+
+static void write_vcd(FILE * out) {
+    uint8_t task_seen[256] = { 0 }, isr_seen[256] = { 0 };
+    char text[32];
+    int running = -1;
+    uint64_t last = header.events ? times[header.events - 1] : 0;
+    uint32_t i;
+
+    for (i = 0; i < header.events; i++) {
+        struct trace_event * ev = &events[i];
+
+        switch (ev->type) {
+        case TRACE_TASK_SWITCH:
+            if (running >= 0) {
+                sprintf(text, "0t%d", running);
+                change(times[i], text);
+            }
+            running = ev->id;
+            task_seen[ev->id] = 1;
+            sprintf(text, "1t%d", running);
+            change(times[i], text);
+            break;
+        case TRACE_TASK_CREATE:
+            task_seen[ev->id] = 1;
+            break;
+        case TRACE_ISR_ENTER:
+            /* Entry only, show a 1us pulse. */
+            isr_seen[ev->id] = 1;
+            sprintf(text, "1i%d", ev->id);
+            change(times[i], text);
+            sprintf(text, "0i%d", ev->id);
+            change(times[i] + 1, text);
+            if (last < times[i] + 1)
+                last = times[i] + 1;
+            break;
+        case TRACE_MALLOC:
+        case TRACE_FREE:
+            heap_change(times[i], heap_used[i]);
+            break;
+        }
+    }
+    qsort(changes, nchanges, sizeof(*changes), change_cmp);
+
+    fprintf(out, "$version\n\tFreeRTOS trace recorder\n$end\n");
+    fprintf(out, "$timescale 1 us $end\n");
+    fprintf(out, "$scope module tasks $end\n");
+    for (i = 0; i < 256; i++)
+        if (task_seen[i])
+            fprintf(out, "$var wire 1 t%u %s $end\n", i, task_name(i));
+    fprintf(out, "$upscope $end\n");
+    fprintf(out, "$scope module isr $end\n");
+    for (i = 0; i < 256; i++)
+        if (isr_seen[i])
+            fprintf(out, "$var wire 1 i%u %s $end\n", i, isr_name(i));
+    fprintf(out, "$upscope $end\n");
+    fprintf(out, "$var reg 32 h heap_used $end\n");
+    fprintf(out, "$enddefinitions $end\n");
+
+    fprintf(out, "#0\n$dumpvars\n");
+    for (i = 0; i < 256; i++) {
+        if (task_seen[i])
+            fprintf(out, "0t%u\n", i);
+        if (isr_seen[i])
+            fprintf(out, "0i%u\n", i);
+    }
+    fprintf(out, "b");
+    for (i = 0; i < 32; i++)
+        fputc(heap_start & (1u << (31 - i)) ? '1' : '0', out);
+    fprintf(out, " h\n$end\n");
+
+    for (i = 0; i < nchanges; i++) {
+        if (!i || changes[i].time != changes[i - 1].time)
+            fprintf(out, "#%llu\n", (unsigned long long) changes[i].time);
+        fprintf(out, "%s\n", changes[i].text);
+    }
+    if (!nchanges || last > changes[nchanges - 1].time)
+        fprintf(out, "#%llu\n", (unsigned long long) last);
+}
+
+/* Chrome trace JSON ------------------------------------------------------*/
+
+static void write_json(FILE * out) {
+    const char * sep = "";
+    int running = -1;
+    uint64_t since = 0;
+    uint32_t i;
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    fprintf(out, "{\"ph\":\"M\",\"pid\":0,\"tid\":0,\"name\":\"thread_name\",\"args\":{\"name\":\"tasks\"}},\n");
+    fprintf(out, "{\"ph\":\"M\",\"pid\":0,\"tid\":1,\"name\":\"thread_name\",\"args\":{\"name\":\"isr\"}}");
+    sep = ",\n";
+
+    for (i = 0; i < header.events; i++) {
+        struct trace_event * ev = &events[i];
+        unsigned long long ts = times[i];
+
+        switch (ev->type) {
+        case TRACE_TASK_SWITCH:
+            if (running >= 0)
+                fprintf(out, "%s{\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%llu,\"dur\":%llu,\"name\":\"%s\"}",
+                        sep, (unsigned long long) since, ts - since, task_name(running));
+            running = ev->id;
+            since = ts;
+            break;
+        case TRACE_TASK_CREATE:
+        case TRACE_TASK_DELETE:
+            fprintf(out, "%s{\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%llu,\"name\":\"%s %s\",\"args\":{\"priority\":%u}}",
+                    sep, ts, ev->type == TRACE_TASK_CREATE ? "create" : "delete",
+                    task_name(ev->id), ev->arg);
+            break;
+        case TRACE_QUEUE_CREATE:
+        case TRACE_QUEUE_SEND:
+        case TRACE_QUEUE_RECEIVE:
+        case TRACE_QUEUE_BLOCK_SEND:
+        case TRACE_QUEUE_BLOCK_RECEIVE:
+            fprintf(out, "%s{\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":0,\"ts\":%llu,\"name\":\"queue %u %s\",\"args\":{\"task\":\"%s\"}}",
+                    sep, ts, ev->arg, queue_op(ev->type), task_name(ev->id));
+            break;
+        case TRACE_ISR_ENTER:
+            fprintf(out, "%s{\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":1,\"ts\":%llu,\"name\":\"%s\"}",
+                    sep, ts, isr_name(ev->id));
+            break;
+        case TRACE_MALLOC:
+        case TRACE_FREE:
+            fprintf(out, "%s{\"ph\":\"C\",\"pid\":0,\"ts\":%llu,\"name\":\"heap\",\"args\":{\"used\":%u}}",
+                    sep, ts, heap_used[i]);
+            break;
+        }
+    }
+
+    /* The running task is still running at the end of the dump. */
+    if (running >= 0 && header.events)
+        fprintf(out, "%s{\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%llu,\"dur\":%llu,\"name\":\"%s\"}",
+                sep, (unsigned long long) since,
+                (unsigned long long) (times[header.events - 1] - since), task_name(running));
+
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+int main(int argc, char ** argv) {
+    const char * format = "vcd";
+    FILE * out = stdout;
+    int c;
+
+    while ((c = getopt(argc, argv, "f:")) != -1) {
+        switch (c) {
+        case 'f':
+            format = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (optind >= argc || argc - optind > 2)
+        usage(argv[0]);
+    if (strcmp(format, "vcd") && strcmp(format, "json"))
+        usage(argv[0]);
+
+    load(argv[optind]);
+
+    if (argc - optind == 2) {
+        out = fopen(argv[optind + 1], "w");
+        if (!out) {
+            perror(argv[optind + 1]);
+            exit(-1);
+        }
+    }
+
+    if (!strcmp(format, "vcd"))
+        write_vcd(out);
+    else
+        write_json(out);
+
+    if (out != stdout)
+        fclose(out);
+
+    return 0;
+}